@@ -0,0 +1,805 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ChunkDownloaderCommon.h"
+#include "Misc/IQueuedWork.h"
+#include "Containers/Queue.h"
+
+template<typename TTask> class FAsyncTask;
+class IHttpRequest;
+class FDownloadChunk;
+class FPakFile;
+class FSHA1;
+class IFileHandle;
+class FAssetRegistryState;
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FPlatformChunkInstallMultiDelegate, uint32, bool);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FPakFileVerifiedMultiDelegate, const FString& /*FileName*/, int32 /*ChunkId*/, bool /*bValid*/);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FAssetScanProgressMultiDelegate, const TArray<int32>& /*ChunkIds*/, int32 /*NumScanned*/, int32 /*NumTotal*/);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FChunkDeadlineMultiDelegate, int32 /*ChunkId*/, const FDateTime& /*Deadline*/, const FDateTime& /*PredictedCompletion*/);
+
+/**
+ * This is a duplicate of Epic's ChunkDownloader plugin, done with the purpose of expanding its functionality to handle pak files that aren't part of the original project's build.
+ * 
+ * The original plugin's aim was to provide a system to handle the packaging and distribution of a project's files, and works under several expectations that are only valid for pak files
+ * that were generated in the whole project's packaging process. For example, it assumes all mount points used by the pak files are tracked and registered automatically by the project.
+ * It also assumes that their contents are tracked and handled by the Asset Registry automatically.
+ * 
+ * These assumptions aren't true for external pak files, and while the missing code to handle them isn't particularly lengthy or complex, the original plugin keeps most of its contents private.
+ * This makes it necessary to work around it and perform redundant tasks to allow for this additional functionality. Extending the class isn't possible either,
+ * since the plugin includes multiple classes that make explicit use of this class and give no room for inheritance or injection.
+ * 
+ * Fortunately, the plugin itself is very self-contained so it's possible to exchange it for this duplicate without breaking anything.
+ * It should even be possible to have both plugins active at the same time, although this is unnecessary since this one performs everything the other does.
+ */
+class CHUNKDOWNLOADERCUSTOM_API FChunkDownloaderCustom : public TSharedFromThis<FChunkDownloaderCustom>
+{
+public:
+	~FChunkDownloaderCustom();
+	typedef TFunction<void(bool bSuccess)> FCallback;
+
+	// a file in a mounted chunk, as indexed when the chunk was mounted
+	enum class EChunkFileType : uint8 { Asset, Map, Other };
+	struct FChunkFile
+	{
+		FName PackageName;	// e.g. /Game/Maps/Level
+		FString Path;		// e.g. /Game/Maps/Level.umap
+		EChunkFileType Type = EChunkFileType::Other;
+
+		// where the entry (its header and stored, i.e. compressed and padded, data) lives in the pak, for prewarming
+		int64 Offset = 0;
+		int64 Size = 0;
+
+		// cooked assets are .uasset and .umap files
+		inline bool IsCooked() const { return Type != EChunkFileType::Other; }
+	};
+
+	// the files of a mounted pak, hashed by the last segment of their package name for loose package lookups
+	struct FContentIndex
+	{
+		TArray<FChunkFile> Files;
+		TMap<FName, TArray<int32>> FilesByLeafName;
+
+		// Path is the file's full package path, with extension
+		void AddFile(FString&& Path, int64 Offset = 0, int64 Size = 0);
+		void Reset();
+
+		// "Maps/Level" and "Level" both match /Game/Maps/Level. Returns the first match in file order, if any.
+		const FChunkFile* FindPackage(FStringView PackageSuffix, bool bCookedOnly = true) const;
+	};
+
+	// static getters
+	static TSharedPtr<FChunkDownloaderCustom> Get();
+	static TSharedRef<FChunkDownloaderCustom> GetChecked();
+	static TSharedRef<FChunkDownloaderCustom> GetOrCreate();
+	static void Shutdown();
+
+public:
+
+	// initialize the download manager (populates the list of cached pak files from disk). Call only once.
+	void Initialize(const FString& PlatformName, int32 TargetDownloadsInFlight);
+
+	// unmount all chunks and cancel any downloads in progress (preserving partial downloads). 
+	// Call only once, don't reuse this object, make a new one.
+	void Finalize();
+
+	// try to load a cached build ID from disk (good to do before updating build so it can possibly no-op)
+	bool LoadCachedBuild(const FString& DeploymentName);
+
+	// set the the content build id
+	// if the content build id has changed, we pull the new BuildManifest from CDN and load it.
+	// the client should compare ContentBuildId with its current embedded build id to determine if this content is 
+	// even compatible BEFORE calling this function. e.g. ContentBuildId="v1.4.22-r23928293" we might consider BUILD_VERSION="1.4.1" 
+	// compatible but BUILD_VERSION="1.3.223" incompatible (needing an update)
+	void UpdateBuild(const FString& DeploymentName, const FString& ContentBuildId, const FCallback& Callback, bool bPreloadCachedBuild = false);
+
+	// get the current status of the specified chunk
+	EChunkStatus GetChunkStatus(int32 ChunkId) const;
+
+	// get status and cached/total bytes for each of the specified chunks (OutStatuses is reset, not reallocated, so it can be reused)
+	void GetChunkStatuses(const TArray<int32>& ChunkIds, TArray<FChunkStatusInfo>& OutStatuses) const;
+
+	// same as GetChunkStatuses for every chunk in the current manifest
+	void GetAllChunkStatuses(TArray<FChunkStatusInfo>& OutStatuses) const;
+
+	// return a list of all chunk IDs in the current manifest
+	void GetAllChunkIds(TArray<int32>& OutChunkIds) const;
+
+	// Download and mount all chunks then fire the callback (convenience wrapper managing multiple MountChunk calls)
+	// with bBatch, the chunks that are ready to mount are mounted together: their mount points are registered in one go and 
+	// bPreScanAssets does a single asset registry scan for all of them, after which OnChunkMounted fires for each.
+	void MountChunks(const TArray<int32>& ChunkIds, const FCallback& Callback, bool bPreScanAssets = false, bool bBatch = false);
+
+	// download all pak files, then asynchronously mount them in order (in order among themselves, async with game thread). 
+	void MountChunk(int32 ChunkId, const FCallback& Callback, bool bPreScanAssets = false);
+
+	// same as MountChunk, for a chunk that's needed within Deadline (from now). See DownloadChunk.
+	void MountChunk(int32 ChunkId, const FTimespan& Deadline, const FCallback& Callback, bool bPreScanAssets = false);
+
+	// Download (Cache) all pak files in these chunks then fire the callback (convenience wrapper managing multiple DownloadChunk calls)
+	void DownloadChunks(const TArray<int32>& ChunkIds, const FCallback& Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
+
+	// download all pak files in the chunk, but don't mount. Callback is fired when all paks have finished caching 
+	// (whether success or failure). Downloads will retry forever, but might fail due to space issues.
+	// download classes (e.g. patch, level content, cosmetics) share the download slots according to their weights (see DownloadClassWeights in config),
+	// priorities and deadlines order the downloads within a class. Top priority (MAX_int32) requests and requests with a deadline bypass the sharing and go first.
+	// a pak file takes the class of its first request, or of a later one at least as urgent (NAME_None being the default class).
+	void DownloadChunk(int32 ChunkId, const FCallback& Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
+
+	// same as DownloadChunk, for a chunk that's needed within Deadline (from now). Among downloads of the same priority, the earliest deadline goes first,
+	// and OnDeadlineAtRisk fires as soon as the measured bandwidth predicts the deadline will be missed.
+	void DownloadChunk(int32 ChunkId, const FTimespan& Deadline, const FCallback& Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
+
+	// Unmount all chunks then fire the callback (convenience wrapper managing multiple UnmountChunk calls)
+	void UnmountChunks(const TArray<int32>& ChunkIds, const FCallback& Callback);
+
+	// Asynchronously mount chunk in reverse order (in order among themselves, async with game thread). 
+	void UnmountChunk(int32 ChunkId, const FCallback& Callback);
+
+	// flush any cached files (on disk) that are not currently being downloaded to or mounting (does not unmount the corresponding pak files).
+	// this will include full and partial downloads, but not active downloads.
+	int32 FlushCache();
+
+	// validate all fully cached files (blocking) by attempting to read them and check their Version hash.
+	// files which were already verified and haven't been modified since (see VerifiedManifest.txt) are not hashed again.
+	// this automatically deletes any files that don't match. Returns the number of files deleted.
+	// in this case best to return to a simple update map and reinitialize ChunkDownloader (or restart).
+	int32 ValidateCache();
+
+	// start verifying cached files in the background whenever we're idle (no downloads, mounts or loading mode), hashing at most BytesPerSecond.
+	// the scrubber resumes where it left off, even across sessions. Findings are reported through OnCacheScrubbed.
+	// (see bCacheScrubber and CacheScrubberBytesPerSecond in config)
+	void StartCacheScrubber(int64 BytesPerSecond);
+	void StopCacheScrubber();
+	inline bool IsCacheScrubberRunning() const { return ScrubTicker.IsValid(); }
+
+	// download every chunk that isn't cached yet, one at a time at the lowest priority, whenever nothing else is queued.
+	// pauses in loading mode (the chunk in flight is canceled) and while the disk quotas would be exceeded. Once started it resumes
+	// in later sessions until stopped. (see bBackgroundInstall, BackgroundInstallMinFreeBytes and BackgroundInstallMaxCacheBytes in config)
+	void StartBackgroundInstall();
+	void StopBackgroundInstall();
+	inline bool IsBackgroundInstalling() const { return BackgroundInstallTicker.IsValid(); }
+	FBackgroundInstallProgress GetBackgroundInstallProgress() const;
+
+	// Snapshot stats and enter into loading screen mode (pauses all background downloads). Fires callback when all non-background 
+	// downloads have completed. If no downloads/mounts are currently queued by the end of the frame, callback will fire next frame.
+	void BeginLoadingMode(const FCallback& Callback);
+
+	// Inspect all files in the paks with the given ID and call a predicate on each inspected file.
+	// returns true if the files were inspected successfully, false if the chunk wasn't found or mounted, or if the chunk contains no valid files.
+	// 
+	// The predicate must return a bool and have two string parameters.
+	// First parameter will contain the filename (without extension) of the file, and second will contain the file's path relative to the pak's mount point (with extension).
+	// Returning false from the predicate will cause the loop to break early. Return true to continue to the next iteration.
+	// by default the predicate will only be called on cooked assets (.uasset and .umap files).
+	bool InspectChunkContent(int32 ChunkId, const TFunction<bool(const FString&, const FString&)>& Predicate, bool bCookedOnly = true) const;
+
+	// same as InspectChunkContent, straight from the chunk's content index (no string conversions or allocations).
+	bool ForEachChunkFile(int32 ChunkId, TFunctionRef<bool(const FChunkFile&)> Predicate, bool bCookedOnly = true) const;
+
+	// find a file in a mounted chunk by (loose) package name, see FContentIndex::FindPackage. Returns nullptr if the chunk can't be inspected or has no such package.
+	const FChunkFile* FindChunkFile(int32 ChunkId, FStringView PackageSuffix, bool bCookedOnly = true) const;
+
+	// find which chunks contain a package (e.g. /Game/Maps/Level), whether they're mounted, cached or still remote.
+	// this knows about the chunks listed in the build's content listing (ChunkContent-<Platform>.txt next to the build manifest, optional)
+	// and about every chunk mounted since the manifest was loaded. Returns false if the package isn't in any known chunk.
+	bool GetChunksForPackage(FName PackageName, TArray<int32>& OutChunkIds) const;
+
+	// find every chunk needed to load a package: the chunks containing it and those containing its hard dependencies, recursively.
+	// dependencies come from the asset registry fragments shipped with the chunks (downloaded with top priority if needed, nothing is mounted) and from 
+	// the asset registry itself for content it already knows about. Packages that aren't in any known chunk are assumed to ship with the game.
+	// the callback gets the chunk ids in ascending order, or false if the package itself isn't in any known chunk (see GetChunksForPackage).
+	typedef TFunction<void(bool bSuccess, const TArray<int32>& ChunkIds)> FChunkClosureCallback;
+	void ResolveChunkClosure(FName PackageName, const FChunkClosureCallback& Callback);
+
+	// make sure the chunks containing a package are mounted, e.g. after failing to load it. Unmounted chunks are downloaded with top priority and mounted,
+	// concurrent requests for the same package share a single acquisition. The callback fires with false if the package isn't in any known chunk
+	// (see GetChunksForPackage) or if any of its chunks failed to mount.
+	void AcquirePackage(FName PackageName, const FCallback& Callback, bool bPreScanAssets = false);
+
+	// read ahead the parts of a mounted chunk's pak files that hold the given packages (the whole chunk if PackageNames is empty) on a background
+	// I/O thread, so that loading them right after doesn't pay for cold reads. At most PrewarmBudgetBytes are warmed per call (see config).
+	// the callback gets the number of bytes read into the cache (-1 if the chunk isn't mounted) and the number of bytes the OS was only advised
+	// to read ahead (where it supports that, those aren't necessarily cached yet). Mounts do this for the whole chunk if bPrewarmMountedChunks is set.
+	typedef TFunction<void(int64 BytesRead, int64 BytesAdvised)> FPrewarmCallback;
+	void PrewarmChunk(int32 ChunkId, const TArray<FName>& PackageNames, const FPrewarmCallback& Callback);
+
+	// prefetch predictor metrics (see bPrefetchPredictor in config). A hit is a mount request for a chunk that was prefetched,
+	// wasted bytes were prefetched for chunks that were flushed or left the build before anyone asked for them.
+	struct FPrefetchStats
+	{
+		int32 NumPrefetches = 0;
+		int32 NumHits = 0;
+		uint64 BytesPrefetched = 0;
+		uint64 BytesHit = 0;
+		uint64 BytesWasted = 0;
+	};
+	inline const FPrefetchStats& GetPrefetchStats() const { return PrefetchStats; }
+
+	// package acquisition metrics (see AcquirePackage). A miss is a request that had to mount something.
+	struct FPackageAcquireStats
+	{
+		int32 NumRequests = 0;
+		int32 NumMisses = 0;
+		int32 NumJoined = 0; // requests that joined an acquisition already in flight
+		int32 NumFailed = 0;
+		double TotalMissSeconds = 0.0;
+		double MaxMissSeconds = 0.0;
+	};
+	inline const FPackageAcquireStats& GetPackageAcquireStats() const { return PackageAcquireStats; }
+
+	// game thread work metrics (see GameThreadFrameBudgetMs in config). Completions, callbacks and manifest saves that don't fit in a frame's
+	// budget are deferred to the next one. A frame goes over budget when a single item (e.g. a mount completion) takes longer than what was left.
+	struct FGameThreadWorkStats
+	{
+		int32 NumFrames = 0; // frames with any downloader game thread work
+		int32 NumFramesOverBudget = 0;
+		int32 NumFramesDeferred = 0; // frames that left work for the next one
+		int32 MaxQueuedItems = 0;
+		double TotalMs = 0.0;
+		double MaxFrameMs = 0.0;
+		double MaxItemMs = 0.0;
+		const TCHAR* MaxItemName = TEXT("none");
+	};
+	const FGameThreadWorkStats& GetGameThreadWorkStats() const;
+
+	// number of mount/unmount tasks started so far (for profiling)
+	inline uint32 GetNumMountTasksStarted() const { return NextMountTaskId; }
+	inline bool IsAcquiringPackages() const { return PackageAcquisitions.Num() > 0; }
+
+	// Inspect all files in the paks with the given ID and scan them with the AssetRegistry.
+	// If the chunk carries a serialized asset registry (a chunk<N>-AssetRegistry.bin manifest entry), that was merged when it mounted instead of scanning the files.
+	// returns the number of files added to the AssetRegistry (can be 0 if the AssetRegistry was already aware of them), or -1 if the chunk wasn't found or mounted.
+	int32 ScanAssetsInChunk(int32 ChunkId) const;
+
+	// same as ScanAssetsInChunk for several chunks, in a single AssetRegistry scan. returns -1 if none of the chunks were found or mounted.
+	// bAllowRegistryFragments = false always scans the files (mainly for profiling).
+	int32 ScanAssetsInChunks(const TArray<int32>& ChunkIds, bool bAllowRegistryFragments = true) const;
+
+	// same as ScanAssetsInChunks, but the files are scanned a few at a time over several frames (within the game thread frame budget, see GameThreadFrameBudgetMs) 
+	// instead of blocking the game thread. Progress is reported through OnAssetScanProgress, and the callback fires once everything was scanned
+	// (false if none of the chunks were found or mounted, or the scan was canceled). Mounts with bPreScanAssets use this when bAsyncAssetScan
+	// is set in config, in which case their callbacks and OnChunkMounted wait for the scan (and fail if the chunk got unmounted meanwhile).
+	void ScanAssetsInChunksAsync(const TArray<int32>& ChunkIds, const FCallback& Callback);
+	inline bool IsScanningAssets() const { return AssetScans.Num() > 0; }
+
+	// if mounted, inspect the files contained in the chunk and export it as an array of soft object pointers of the desired class, optionally filtering the results further.
+	// if bPreScanAssets is set to true, all chunk contents will be scanned to make sure the AssetRegistry is aware of them before searching for the desired assets.
+	bool GetChunkContent(int32 ChunkId, TArray<TSoftObjectPtr<UObject>>& Content,
+		bool bPreScanAssets = false,
+		const FName& PackageName = FName(),
+		const FName& PackagePath = FName(), bool bRecursivePath = true,
+		const TSubclassOf<UObject>& Class = TSubclassOf<UObject>(), bool bRecursiveClass = true
+	) const;
+
+	// Called whenever a chunk mounts (success or failure). ONLY USE THIS IF YOU WANT TO PASSIVELY LISTEN FOR MOUNTS (otherwise use the proper request callback on MountChunk)
+	FPlatformChunkInstallMultiDelegate OnChunkMounted;
+	// Called whenever a chunk mounts (success or failure). ONLY USE THIS IF YOU WANT TO PASSIVELY LISTEN FOR MOUNTS (otherwise use the proper request callback on MountChunk)
+	FPlatformChunkInstallMultiDelegate OnChunkUnmounted;
+
+	// called whenever the cache scrubber finishes checking a file. Invalid files are deleted unless they're mounted, 
+	// in which case it's up to the listener to unmount their chunk (they will be verified again before the next mount).
+	FPakFileVerifiedMultiDelegate OnCacheScrubbed;
+
+	// called after each slice of an asynchronous asset scan, with the number of files scanned so far out of the total for that scan.
+	FAssetScanProgressMultiDelegate OnAssetScanProgress;
+
+	// called when a chunk requested with a deadline is predicted to miss it, given the downloads ahead of it and the measured bandwidth.
+	// fires once per deadline, while there's still time to react (e.g. keep the loading screen up).
+	FChunkDeadlineMultiDelegate OnDeadlineAtRisk;
+
+	// smoothed download bandwidth measured while downloads are in progress, in bytes per second (0 until measured)
+	inline double GetDownloadBandwidth() const { return DownloadBandwidth; }
+
+	// called each time a download attempt finishes (success or failure). ONLY USE THIS IF YOU WANT TO PASSIVELY LISTEN. Downloads retry until successful.
+	TFunction<void(const FString& FileName, const FString& Url, uint64 SizeBytes, const FTimespan& DownloadTime, int32 HttpStatus)> OnDownloadAnalytics;
+
+	// get the current content build ID
+	inline const FString& GetContentBuildId() const { return ContentBuildId; }
+	// get the most recent deployment name
+	inline const FString& GetDeploymentName() const { return LastDeploymentName; }
+	// get the most recent build base URLs
+	inline const TArray<FString>& GetBuildBaseUrls() const { return BuildBaseUrls; }
+
+	// get the last parsed data in the cached manifest, as saved by SaveLocalManifest
+	// 
+	// NOTE: Should be called only after Initialize, and before Finalize
+	// If called before LoadCachedBuild and/or UpdateBuild, the provided data will have invalid ChunkID and RelativeUrl props
+	// This is because Initialize parses the LocalManifest.txt file directly, which doesn't save them.
+	inline const TArray<FPakManifestEntry>& GetLocalManifest() const { return LastLocalManifest; }
+
+	// get the current loading stats (generally only useful if you're in loading mode see BeginLoadingMode)
+	inline const FChunkStats& GetLoadingStats() const { return LoadingModeStats; }
+
+	// with lazy mount verification, cached paks that haven't been verified yet are mounted after checking their footer, index and a few sampled files.
+	// the rest of the file is then hashed in the background, and the pak is unmounted and repaired if it doesn't match. (see bLazyMountVerification in config)
+	inline void SetLazyMountVerification(bool bEnabled) { bLazyMountVerification = bEnabled; }
+	inline bool IsLazyMountVerificationEnabled() const { return bLazyMountVerification; }
+
+	// get current number of download requests, so we know whether download is in progress. Downloading Requests will be removed from this array in it's FDownloadCustom::OnCompleted callback.
+	inline int32 GetNumDownloadRequests() const { return DownloadRequests.Num(); }
+
+	static void DumpLoadedChunks();
+
+	// chunk status as logable string
+	static const TCHAR* ChunkStatusToString(EChunkStatus Status);
+
+	// Check an opened pak file's size and the hashes of a few randomly picked files within it (all of them if NumSamples covers every file)
+	// against the entry headers stored with their data. Opening the pak already validated its footer and index, so this is a cheap way
+	// to catch truncated or corrupted files.
+	static bool CheckPakFileSamples(const FPakFile& Pak, const FString& FullPathOnDisk, uint64 ExpectedFileSize, int32 NumSamples);
+
+protected:
+	friend class UChunkDownloaderSubsystem;
+	friend class FChunkDownloaderCustomModule;
+	friend class FChunkDownloaderCustomPlatformWrapper;
+	friend class FDownloadChunk;
+
+	FChunkDownloaderCustom();
+
+	static bool WriteStringAsUtf8TextFile(const FString& FileText, const FString& FilePath);
+	static bool CheckFileSha1Hash(const FString& FullPathOnDisk, const FString& Sha1HashStr);
+
+	// Hash the next Size bytes of an open file (reading in 64K chunks), and build the hash string of a finished hash.
+	static bool HashFileRange(IFileHandle& File, int64 Size, FSHA1& HashContext, const FString& FullPathOnDisk);
+	static FString FinalizeSha1HashString(FSHA1& HashContext);
+
+	// Take in the path to a manifest text file in and parse its contents to build an array of FPakFileEntries to keep track of the pak files that are expected to be downloaded and mounted.
+	// Optionally, a pointer to map of strings to strings can be provided to output the properties included in the manifest, used mainly for file versioning.
+	static TArray<FPakManifestEntry> ParseManifest(const FString& ManifestPath, TMap<FString, FString>* Properties = nullptr);
+
+	static FString GetRootDir(const FString& MountPoint);
+	static bool IsMountingToRoot(const FString& MountPoint);
+	static bool IsMountPointRegistered(const FString& MountPoint);
+
+	// Take in a the mount point of a pak file (as provided by FPakFile::GetMountPoint()) and try to figure out the root direction to register it with (with FPackageName::RegisterMountPoint()). 
+	// For pak files that were packaged together with the main project, this is not necessary because all required mount points are tracked and registered automatically.
+	// But for pak files that are generated outside the main project, there's no way for it to track them, and registration must be made explicitly.
+	static bool ParseRootDir(const FString& MountPoint, FString& Result);
+
+private:
+	class FMultiCallback;
+
+	enum class ERegistryStatus : uint8 { Untracked, Registered, Unregistered };
+	enum class EVerifyStatus : uint8 { Unverified, Verifying, Sampled, Verified, Failed }; // failed: invalid and couldn't be deleted
+	enum class EChunkMountOp : uint8 { None, Mount, Unmount };
+
+	// entry per file in the verified manifest
+	struct FVerifiedFileEntry
+	{
+		uint64 FileSize = 0;
+		FString FileVersion;
+		FDateTime TimeStamp;
+		FDateTime VerifiedAt;
+	};
+
+	// entry per pak file 
+	// CUSTOM: renamed because there is an FPakFile class in IPlatformFilePak.h and unlike Epic's ChunkDownloader plugin, we need to use it.
+	struct FPakFileRecord
+	{
+		FPakManifestEntry Entry;
+		bool bIsCached = false;
+		bool bIsMounted = false;
+		bool bIsEmbedded = false;
+		ERegistryStatus IsRegistered = ERegistryStatus::Untracked;
+
+		// Pointer to the mounted pak file object.
+		TRefCountPtr<FPakFile> Pak;
+
+		// index of the files in the pak, built by the mount task and released when unmounting
+		FContentIndex Content;
+
+		// chunks can carry a serialized asset registry next to their paks, downloaded and cached like them but never mounted
+		inline bool IsAssetRegistryFragment() const { return Entry.FileName.EndsWith(TEXT("-AssetRegistry.bin")); }
+
+		// grows as the file is downloaded. See Entry.FileSize for the target size
+		uint64 SizeOnDisk = 0;
+
+		// async download
+		int32 Priority = 0;
+		FDateTime Deadline = FDateTime::MaxValue();
+		bool bDeadlineAtRisk = false;
+		FName DownloadClass; // none is the default class
+		TSharedPtr<FDownloadChunk> Download;
+		TArray<FCallback> PostDownloadCallbacks;
+
+		// hash verification. A file can be cached (size matches) without being verified, e.g. if we crashed mid-write.
+		// TimeStamp is the file's modification time when it was verified, a different one invalidates the verification.
+		EVerifyStatus VerifyStatus = EVerifyStatus::Unverified;
+		FDateTime VerifiedTimeStamp;
+		FDateTime VerifiedAt;
+		TArray<FCallback> PostVerifyCallbacks;
+	};
+
+	// represents an async mount
+	class FPakMountWork;
+	struct FPakMountWorkResult
+	{
+		FPakMountWorkResult(FPakFile* Pak);
+		TRefCountPtr<FPakFile> Pak;
+		ERegistryStatus IsRegistered = ERegistryStatus::Untracked;
+		EVerifyStatus VerifyStatus = EVerifyStatus::Unverified;
+		FContentIndex Content;
+	};
+	typedef FAsyncTask<FPakMountWork> FMountTask;
+
+	// chunks mounted together by MountChunks(..., bBatch), completed all at once when the last of them is done
+	struct FMountBatch
+	{
+		int32 NumTasks = 0;
+		TArray<FMountTask*> FinishedTasks;
+		TArray<TPair<int32, bool>> MountResults;
+
+		// post-mount callbacks (by chunk) held back until the batch's asynchronous asset scan is done
+		TArray<TPair<int32, FCallback>> PostScanCallbacks;
+	};
+
+	// register the mount point of a freshly mounted pak if nobody did yet
+	static ERegistryStatus RegisterPakMountPoint(const FString& MountPoint, const FString& FullPathOnDisk, int32 ChunkId);
+
+	// entry per chunk
+	struct FChunk
+	{
+		int32 ChunkId = -1;
+		bool bIsMounted = false;
+		TArray<TSharedRef<FPakFileRecord>> PakFiles;
+
+		// whether the current mount scanned the asset registry (a repair mounts it again the same way)
+		bool bPreScanAssets = false;
+
+		// assets merged from the chunk's serialized asset registry when it mounted (INDEX_NONE if it has none)
+		int32 NumRegistryFragmentAssets = INDEX_NONE;
+
+		inline bool IsCached() const
+		{
+			for (const auto& PakFile : PakFiles)
+			{
+				if (!PakFile->bIsCached)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		inline bool IsRegistered() const
+		{
+			checkf(bIsMounted, TEXT("Unmounted PakFiles are always flagged as untracked so this would return a false positive. Always make sure the chunk is mounted before calling this."))
+				for (const auto& PakFile : PakFiles)
+				{
+					if (PakFile->IsRegistered == ERegistryStatus::Unregistered)
+					{
+						return false;
+					}
+				}
+			return true;
+		}
+
+		// async mount
+		FMountTask* MountTask = nullptr;
+
+		// opposite operation requested while MountTask was already running, started as soon as it completes
+		EChunkMountOp QueuedOp = EChunkMountOp::None;
+		bool bQueuedPreScanAssets = false;
+		TArray<FCallback> QueuedCallbacks;
+
+		// bumped by every unmount request so mounts still waiting on downloads can tell they were superseded
+		uint32 UnmountSerial = 0;
+
+		// packages this chunk contributed to the package to chunk index
+		TArray<FName> IndexedPackages;
+
+		// status cache, recomputed on demand after any of its pak files changed state (see InvalidateChunkStatus)
+		mutable EChunkStatus CachedStatus = EChunkStatus::Unknown;
+		mutable uint64 CachedBytesCached = 0;
+		mutable uint64 CachedBytesTotal = 0;
+		mutable bool bStatusDirty = true;
+	};
+
+	void SetContentBuildId(const FString& DeploymentName, const FString& NewContentBuildId);
+
+	// block waiting for any pending mounts to finish
+	// then collect garbage to clean up any references to chunks.
+	// then create entries for any new chunks
+	// for any chunks that change, cancel downloads and unmount invalid paks (and any after invalid paks).
+	// If a changed chunk was mounted, then inline mount all non-mounted paks in the new list (in order)  
+	// then unload any chunks that no longer exist (cancel downloads and unmount all paks)
+	void LoadManifest(const TArray<FPakManifestEntry>& PakFiles);
+
+	void TryLoadBuildManifest(int32 TryNumber);
+	void TryDownloadBuildManifest(int32 TryNumber);
+
+	// package to chunk index
+	void LoadContentListing();
+	void ApplyContentListing(const FString& ListingText);
+	void IndexChunkPackages(FChunk& Chunk, TArray<FName>&& Packages);
+	void UnindexChunkPackages(FChunk& Chunk);
+
+	// on-demand package acquisition
+	struct FPackageAcquisition
+	{
+		double StartTime = 0.0;
+		TArray<FCallback> Callbacks;
+	};
+	void CompletePackageAcquisition(FName PackageName, bool bSuccess);
+
+	// learned chunk access sequences, used to prefetch the likeliest next chunks
+	void LoadChunkTransitions();
+	void SaveChunkTransitions(bool bForce);
+	void WriteChunkTransitions(bool bForce);
+	void RecordChunkAccess(TConstArrayView<int32> ChunkIds);
+	void PrefetchLikelyChunks(int32 ChunkId);
+	void CheckPrefetchedChunks();
+	void PausePrefetches();
+
+	// dependency closure resolution, fragments are loaded once per resolution (null if the chunk has none)
+	struct FChunkClosure
+	{
+		FName RootPackage;
+		TArray<FName> Frontier;
+		TArray<FName> Deferred;
+		TSet<FName> VisitedPackages;
+		TSet<int32> ChunkIds;
+		TMap<int32, TSharedPtr<FAssetRegistryState>> Fragments;
+		FChunkClosureCallback Callback;
+	};
+	void ContinueChunkClosure(const TSharedRef<FChunkClosure>& Closure);
+
+	// unforced saves are coalesced into one write on the deferred game thread work
+	void SaveLocalManifest(bool bForce);
+	void WriteLocalManifest(bool bForce);
+	void SaveVerifiedManifest(bool bForce);
+
+	void WaitForMounts();
+	bool UpdateLoadingMode();
+	void ComputeLoadingStats();
+
+	void UnmountPakFile(const TSharedRef<FPakFileRecord>& PakFile);
+	void CancelDownload(const TSharedRef<FPakFileRecord>& PakFile, bool bResult);
+	
+	void DownloadChunkInternal(const FChunk& Chunk, const FCallback& Callback, int32 Priority, FName DownloadClass = NAME_None);
+	void DownloadPakFileInternal(const TSharedRef<FPakFileRecord>& PakFile, const FCallback& Callback, int32 Priority, FName DownloadClass = NAME_None);
+	float GetDownloadClassWeight(FName DownloadClass) const;
+	static bool IsUrgentDownload(const FPakFileRecord& PakFile);
+	void SetChunkDeadline(const FChunk& Chunk, const FDateTime& Deadline);
+	void SortDownloadRequests();
+	bool UpdateDownloadSchedule(float DeltaTime);
+	void CheckDeadlines();
+	
+	void MountChunkInternal(FChunk& Chunk, bool bPreScanAssets, const FCallback& Callback);
+
+	// MountChunk without recording an access, for mounts we issue again ourselves (after downloads, verification, repairs...)
+	void MountChunkById(int32 ChunkId, const FCallback& Callback, bool bPreScanAssets);
+	void UnmountChunkInternal(FChunk& Chunk, const FCallback& Callback);	
+
+	void InvalidateChunkStatus(const FPakFileRecord& PakFile);
+	void RefreshChunkStatus(const FChunk& Chunk) const;
+	bool IsReadyToMount(const FChunk& Chunk) const;
+	const FChunk* FindInspectableChunk(int32 ChunkId) const;
+	static void BuildContentIndex(const FPakFile& Pak, FContentIndex& OutContent);
+	// page cache prewarming, Ranges are (offset, size) pairs
+	struct FPrewarmFile
+	{
+		FString FullPathOnDisk;
+		TArray<TPair<int64, int64>> Ranges;
+	};
+	static int64 PrewarmFile(const FPrewarmFile& File, int64& OutBytesAdvised);
+	int32 PrepareAssetScan(const TArray<int32>& ChunkIds, bool bAllowRegistryFragments, TSet<FString>& OutPackageStrings) const;
+	void CreateMountTask(FChunk& Chunk, bool bPreScanAssets, const FCallback& Callback, const TSharedPtr<FMountBatch>& Batch = nullptr);
+	void StartMountTask(FChunk& Chunk);
+	void FinishMountTask(FMountTask* MountTask);
+	void CompleteMountBatch(TSharedRef<FMountBatch> Batch);
+	bool TryCancelMountTask(FChunk& Chunk);
+	void QueueChunkOp(FChunk& Chunk, EChunkMountOp Op, bool bPreScanAssets, const FCallback& Callback);
+	void DiscardQueuedChunkOp(FChunk& Chunk);
+	void RunQueuedChunkOp(FChunk& Chunk);
+	bool IsMountSuperseded(int32 ChunkId, uint32 UnmountSerial) const;
+	bool IsStillMounted(int32 ChunkId, uint32 UnmountSerial) const;
+	void CompleteMountTask(FChunk& Chunk);
+	bool UpdateMountTasks(float dts);
+	void ExecuteNextTick(const FCallback& Callback, bool bSuccess);
+
+	// game thread work that can wait for the next frame, done in order within the per-frame budget
+	struct FGameThreadWork;
+	void DeferWork(const TCHAR* Name, TUniqueFunction<void()>&& Work);
+
+	void IssueDownloads();
+	void StartDownload(const TSharedRef<FPakFileRecord>& PakFile);
+
+	// transfers finished by the HTTP and I/O threads (file written and validated), handed back to the game thread.
+	// the queue is shared with the workers, so a transfer finishing after Finalize still has somewhere to go.
+	struct FDownloadResult
+	{
+		TWeakPtr<FDownloadChunk> Download;
+		FString FileName;
+		FString Url;
+		int32 TryNumber = 0;
+		int32 HttpStatus = 0;
+		bool bFileIsValid = false;
+	};
+	typedef TQueue<FDownloadResult, EQueueMode::Mpsc> FDownloadResultQueue;
+	bool UpdateDownloads(float dts);
+
+	// deletes a cached file now, or once the transfers still writing to it have been drained from DownloadResults
+	bool DeleteCachedFile(const FString& FileName);
+
+	// verification of cached files
+	// the verified manifest is a table of files whose hash has already been verified, as saved by SaveVerifiedManifest, keyed by file name.
+	static TMap<FString, FVerifiedFileEntry> ParseVerifiedManifest(const FString& ManifestPath, TMap<FString, FString>* Properties = nullptr);
+	static bool CanVerifyPakFile(const FPakFileRecord& PakFile);
+	bool IsPakFileVerified(const FPakFileRecord& PakFile) const;
+	void MarkPakFileVerified(FPakFileRecord& PakFile);
+	void EvictPakFile(FPakFileRecord& PakFile);
+	void InvalidatePakFile(const TSharedRef<FPakFileRecord>& PakFile);
+	void RepairMountedPakFile(const TSharedRef<FPakFileRecord>& PakFile);
+	void VerifyPakFileInternal(const TSharedRef<FPakFileRecord>& PakFile, const FCallback& Callback, EQueuedWorkPriority Priority);
+	void CompleteVerification(const TSharedRef<FPakFileRecord>& PakFile, bool bFileIsValid);
+
+	// rolling cache verification
+	struct FCacheScrub;
+	bool IsIdle() const;
+	bool UpdateCacheScrubber(float dts);
+	void CompleteCacheScrubSlice(const TSharedRef<FCacheScrub, ESPMode::ThreadSafe>& Scrub);
+
+	// whole-catalog background install
+	bool UpdateBackgroundInstall(float dts);
+	const TCHAR* GetBackgroundInstallPauseReason(const FChunk& Chunk) const;
+	void PauseBackgroundInstall();
+
+	// time-sliced asset registry scans
+	struct FAssetScan
+	{
+		TArray<int32> ChunkIds;
+		TArray<FString> PackageStrings;
+		int32 NumScanned = 0;
+		int32 NumAssets = 0;
+		FCallback Callback;
+	};
+	bool UpdateAssetScans(float dts);
+	void CancelAssetScans();
+
+private:
+
+	// cumulative stats for loading screen mode
+	FChunkStats LoadingModeStats;
+	TArray<FCallback> PostLoadCallbacks;
+	int32 LoadingCompleteLatch = 0;
+
+	FCallback UpdateBuildCallback;
+
+	// platform name (determines the manifest)
+	FString PlatformName;
+
+	// folders to save pak files into on disk
+	FString CacheFolder;
+
+	// content folder where we can find some chunks shipped with the build
+	FString EmbeddedFolder;
+
+	// build specific ID and URL paths
+	FString LastDeploymentName;
+	FString ContentBuildId;
+	TArray<FString> BuildBaseUrls;
+
+	// a copy of the data in the local manifest, updated everytime it's written (see SaveLocalManifest).
+	TArray<FPakManifestEntry> LastLocalManifest;
+
+	// chunk id to chunk record
+	TMap<int32, TSharedRef<FChunk>> Chunks;
+
+	// pak file name to pak file record
+	TMap<FString, TSharedRef<FPakFileRecord>> PakFiles;
+
+	// pak files embedded in the build (immutable, compressed)
+	TMap<FString, FPakManifestEntry> EmbeddedPaks;
+
+	// do we need to save the manifest (done whenever new downloads have started)
+	bool bNeedsManifestSave = false;
+	bool bManifestSaveDeferred = false;
+
+	// do we need to save the verified manifest (done whenever a file is verified or invalidated)
+	bool bNeedsVerifiedManifestSave = false;
+
+	// rolling cache verification (the cursor is the name of the last file checked)
+	FTSTicker::FDelegateHandle ScrubTicker;
+	TSharedPtr<FCacheScrub, ESPMode::ThreadSafe> CacheScrub;
+	bool bCacheScrubInFlight = false;
+	int64 ScrubBytesPerSecond = 0;
+	double ScrubBudget = 0.0;
+	FString ScrubCursor;
+
+	// whole-catalog background install (the chunk in flight, if any, and the chunks that failed this session)
+	FTSTicker::FDelegateHandle BackgroundInstallTicker;
+	int32 BackgroundInstallChunk = INDEX_NONE;
+	const TCHAR* BackgroundInstallPauseReason = nullptr;
+	TSet<int32> BackgroundInstallSkipped;
+	int64 BackgroundInstallMinFreeBytes = 1024 * 1024 * 1024;
+	int64 BackgroundInstallMaxCacheBytes = 0; // 0 is unlimited
+
+	// mount unverified paks after sampling them, then finish verifying them in the background
+	bool bLazyMountVerification = false;
+	int32 NumLazyVerificationSamples = 16;
+
+	// handle for the per-frame mount ticker in the main thread
+	FTSTicker::FDelegateHandle MountTicker;
+
+	// asynchronous asset registry scans, processed in order (see bAsyncAssetScan and AssetScanSliceSize in config)
+	FTSTicker::FDelegateHandle AssetScanTicker;
+	TArray<TSharedRef<FAssetScan>> AssetScans;
+	bool bAsyncAssetScan = false;
+	int32 AssetScanSliceSize = 16;
+
+	// page cache prewarming (see PrewarmChunk)
+	bool bPrewarmMountedChunks = false;
+	int64 PrewarmBudgetBytes = 256 * 1024 * 1024;
+
+	// mount tasks in flight by task id. Workers push their id to the completion queue when they're done, 
+	// so the mount ticker only has to look at tasks that actually finished.
+	TMap<uint32, FMountTask*> PendingMountTasks;
+	TQueue<uint32, EQueueMode::Mpsc> MountCompletions;
+	uint32 NextMountTaskId = 0;
+
+	// deferred game thread work and the frame budget it shares with mount completions. The queue is shared with its ticker
+	// so that callbacks deferred by Finalize still fire after we're gone.
+	TSharedRef<FGameThreadWork> GameThreadWork;
+
+	// manifest download request
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> ManifestRequest;
+
+	// package name to the chunks that contain it (almost always a single one)
+	TMap<FName, TArray<int32, TInlineAllocator<1>>> PackageChunks;
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> ContentListingRequest;
+
+	// how many times each chunk was requested right after another one (from chunk, to chunk, count), persisted across sessions.
+	// see bPrefetchPredictor, PrefetchMinProbability, PrefetchMaxChunks and PrefetchBudgetBytes in config.
+	TMap<int32, TMap<int32, int32>> ChunkTransitions;
+	TArray<int32> LastAccessedChunks;
+	bool bNeedsTransitionSave = false;
+	bool bTransitionSaveDeferred = false;
+	bool bPrefetchPredictor = false;
+	float PrefetchMinProbability = 0.3f;
+	int32 PrefetchMaxChunks = 1;
+	int64 PrefetchBudgetBytes = 512 * 1024 * 1024;
+
+	// prefetched chunks nobody asked for yet, with the number of bytes we downloaded for them
+	TMap<int32, uint64> PrefetchedChunks;
+	FPrefetchStats PrefetchStats;
+
+	// package acquisitions in flight by package name
+	TMap<FName, TSharedRef<FPackageAcquisition>> PackageAcquisitions;
+	FPackageAcquireStats PackageAcquireStats;
+
+	// maximum number of downloads to allow concurrently
+	int32 TargetDownloadsInFlight = 1;
+
+	// share of the download slots of each download class when they're contended (unlisted classes weigh 1)
+	TMap<FName, float> DownloadClassWeights;
+
+	// list of pak files that have been requested
+	TArray<TSharedRef<FPakFileRecord>> DownloadRequests;
+
+	// per-frame ticker picking up download progress and results from the other threads while downloads are in flight
+	FTSTicker::FDelegateHandle DownloadTicker;
+	TSharedRef<FDownloadResultQueue, ESPMode::ThreadSafe> DownloadResults;
+
+	// transfers started per cached file whose result hasn't been drained from DownloadResults yet. A canceled transfer
+	// may still be writing its file, so the file isn't downloaded again or deleted until then (see DeferredFileDeletes).
+	TMap<FString, int32> TransfersInFlight;
+	TSet<FString> DeferredFileDeletes;
+
+	// bytes left to download across all DownloadRequests (kept up to date as requests are added, progress and complete)
+	uint64 DownloadRequestBytesRemaining = 0;
+
+	// bandwidth measurement while DownloadRequests isn't empty, sampled every second and smoothed (see DownloadBandwidthSmoothing in config)
+	FTSTicker::FDelegateHandle DownloadScheduleTicker;
+	uint64 TotalBytesReceived = 0;
+	uint64 BandwidthSampleBytes = 0;
+	double BandwidthSampleTime = 0.0;
+	double DownloadBandwidth = 0.0;
+	float DownloadBandwidthSmoothing = 0.3f;
+};
+
+#if UE_ENABLE_INCLUDE_ORDER_DEPRECATED_IN_5_2
+#include "CoreMinimal.h"
+#endif
@@ -0,0 +1,489 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChunkDownloaderSubsystem.h"
+#include "ChunkDownloader.h"
+#include "ChunkDownloaderLog.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/World.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/UObjectHash.h"
+
+// the world of a freshly loaded map package plus the assets of every loaded package it (transitively) hard depends on, 
+// as far as the asset registry knows. The world already references most of them through its actors.
+static void GatherPreparedLevelObjects(UPackage* MapPackage, TArray<TObjectPtr<UObject>>& OutObjects)
+{
+	UWorld* World = UWorld::FindWorldInPackage(MapPackage);
+	if (World == nullptr)
+	{
+		return;
+	}
+	TSet<UObject*> Objects = { World };
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	const UE::AssetRegistry::FDependencyQuery HardDependencies(UE::AssetRegistry::EDependencyQuery::Hard);
+	TSet<FName> VisitedPackages = { MapPackage->GetFName() };
+	TArray<FName> Frontier = { MapPackage->GetFName() };
+	TArray<FAssetIdentifier> Dependencies;
+	TArray<UObject*> PackageObjects;
+	while (Frontier.Num() > 0)
+	{
+		const FName PackageName = Frontier.Pop(false);
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(FAssetIdentifier(PackageName), Dependencies, UE::AssetRegistry::EDependencyCategory::Package, HardDependencies);
+		for (const FAssetIdentifier& Dependency : Dependencies)
+		{
+			if (Dependency.PackageName.IsNone() || FPackageName::IsScriptPackage(Dependency.PackageName.ToString()) || VisitedPackages.Contains(Dependency.PackageName))
+			{
+				continue;
+			}
+			VisitedPackages.Add(Dependency.PackageName);
+
+			// only what the map load actually brought in
+			UPackage* Package = FindPackage(nullptr, *Dependency.PackageName.ToString());
+			if (Package == nullptr)
+			{
+				continue;
+			}
+			PackageObjects.Reset();
+			GetObjectsWithPackage(Package, PackageObjects, false);
+			for (UObject* Object : PackageObjects)
+			{
+				if (Object->IsAsset())
+				{
+					Objects.Add(Object);
+				}
+			}
+			Frontier.Add(Dependency.PackageName);
+		}
+	}
+	OutObjects.Append(Objects.Array());
+}
+
+void UChunkDownloaderSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	const FString& PlatformName = FPlatformProperties::IniPlatformName();
+	int32 TargetDownloadsInFlight = FGenericPlatformMisc::NumberOfCores();
+	TSharedRef<FChunkDownloaderCustom> ChunkDownloader = FChunkDownloaderCustom::GetOrCreate();
+	ChunkDownloader->Initialize(PlatformName, TargetDownloadsInFlight);
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UChunkDownloaderSubsystem::OnPostLoadMap);
+	DeadlineAtRiskHandle = ChunkDownloader->OnDeadlineAtRisk.AddWeakLambda(this, [this](int32 ChunkId, const FDateTime& Deadline, const FDateTime& PredictedCompletion)
+		{
+			OnDeadlineAtRisk.Broadcast(ChunkId, Deadline, PredictedCompletion);
+		});
+}
+
+void UChunkDownloaderSubsystem::Deinitialize() {
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	FChunkDownloaderCustom::GetChecked()->OnDeadlineAtRisk.Remove(DeadlineAtRiskHandle);
+	PreparedLevels.Empty();
+	FChunkDownloaderCustom::Shutdown();
+}
+
+bool UChunkDownloaderSubsystem::LoadCachedBuild(const FString& DeploymentName)
+{
+	return FChunkDownloaderCustom::GetChecked()->LoadCachedBuild(DeploymentName);
+}
+
+void UChunkDownloaderSubsystem::UpdateBuild(const FString& DeploymentName, const FString& ContentBuildId, bool bPreloadCachedBuild, FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->UpdateBuild(DeploymentName, ContentBuildId, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); }, bPreloadCachedBuild);
+}
+
+void UChunkDownloaderSubsystem::UpdateBuild(const FString& DeploymentName, const FString& ContentBuildId, bool bPreloadCachedBuild, FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->UpdateBuild(DeploymentName, ContentBuildId, Callback, bPreloadCachedBuild);
+}
+
+FString UChunkDownloaderSubsystem::GetContentBuildId() const
+{
+	return FChunkDownloaderCustom::GetChecked()->GetContentBuildId();
+}
+
+FString UChunkDownloaderSubsystem::GetDeploymentName() const
+{
+	return FChunkDownloaderCustom::GetChecked()->GetDeploymentName();
+}
+
+TArray<FString> UChunkDownloaderSubsystem::GetBuildBaseUrls() const
+{
+	return FChunkDownloaderCustom::GetChecked()->GetBuildBaseUrls();
+}
+
+TArray<FPakManifestEntry> UChunkDownloaderSubsystem::GetLocalManifest() const
+{
+	return FChunkDownloaderCustom::GetChecked()->GetLocalManifest();
+}
+
+void UChunkDownloaderSubsystem::DumpLoadedChunks()
+{
+	FChunkDownloaderCustom::GetChecked()->DumpLoadedChunks();
+}
+
+FString UChunkDownloaderSubsystem::ChunkStatusToString(EChunkStatus Status)
+{
+	return FChunkDownloaderCustom::ChunkStatusToString(Status);
+}
+
+EChunkStatus UChunkDownloaderSubsystem::GetChunkStatus(int32 ChunkId) const
+{
+	return FChunkDownloaderCustom::GetChecked()->GetChunkStatus(ChunkId);
+}
+
+void UChunkDownloaderSubsystem::GetAllChunkIds(TArray<int32>& OutChunkIds) const
+{
+	FChunkDownloaderCustom::GetChecked()->GetAllChunkIds(OutChunkIds);
+}
+
+void UChunkDownloaderSubsystem::GetChunkStatuses(const TArray<int32>& ChunkIds, TArray<FChunkStatusInfo>& OutStatuses) const
+{
+	FChunkDownloaderCustom::GetChecked()->GetChunkStatuses(ChunkIds, OutStatuses);
+}
+
+void UChunkDownloaderSubsystem::GetAllChunkStatuses(TArray<FChunkStatusInfo>& OutStatuses) const
+{
+	FChunkDownloaderCustom::GetChecked()->GetAllChunkStatuses(OutStatuses);
+}
+
+void UChunkDownloaderSubsystem::UnmountChunks(const TArray<int32>& ChunkIds, FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->UnmountChunks(ChunkIds, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); });
+}
+
+void UChunkDownloaderSubsystem::UnmountChunks(const TArray<int32>& ChunkIds, FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->UnmountChunks(ChunkIds, Callback);
+}
+
+void UChunkDownloaderSubsystem::UnmountChunk(int32 ChunkId, FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->UnmountChunk(ChunkId, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); });
+}
+
+void UChunkDownloaderSubsystem::UnmountChunk(int32 ChunkId, FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->UnmountChunk(ChunkId, Callback);
+}
+
+void UChunkDownloaderSubsystem::MountChunks(const TArray<int32>& ChunkIds, bool bPreScanAssets, FCallbackDelegate Callback, bool bBatch)
+{
+	FChunkDownloaderCustom::GetChecked()->MountChunks(ChunkIds, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); }, bPreScanAssets, bBatch);
+}
+
+void UChunkDownloaderSubsystem::MountChunks(const TArray<int32>& ChunkIds, bool bPreScanAssets, FCallback Callback, bool bBatch)
+{
+	FChunkDownloaderCustom::GetChecked()->MountChunks(ChunkIds, Callback, bPreScanAssets, bBatch);
+}
+
+void UChunkDownloaderSubsystem::MountChunk(int32 ChunkId, bool bPreScanAssets, FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->MountChunk(ChunkId, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); }, bPreScanAssets);
+}
+
+void UChunkDownloaderSubsystem::MountChunk(int32 ChunkId, bool bPreScanAssets, FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->MountChunk(ChunkId, Callback, bPreScanAssets);
+}
+
+void UChunkDownloaderSubsystem::MountChunkBefore(int32 ChunkId, FTimespan Deadline, bool bPreScanAssets, FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->MountChunk(ChunkId, Deadline, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); }, bPreScanAssets);
+}
+
+void UChunkDownloaderSubsystem::MountChunkBefore(int32 ChunkId, FTimespan Deadline, bool bPreScanAssets, FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->MountChunk(ChunkId, Deadline, Callback, bPreScanAssets);
+}
+
+void UChunkDownloaderSubsystem::DownloadChunks(const TArray<int32>& ChunkIds, FCallbackDelegate Callback, int32 Priority, FName DownloadClass)
+{
+	FChunkDownloaderCustom::GetChecked()->DownloadChunks(ChunkIds, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); }, Priority, DownloadClass);
+}
+
+void UChunkDownloaderSubsystem::DownloadChunks(const TArray<int32>& ChunkIds, FCallback Callback, int32 Priority, FName DownloadClass)
+{
+	FChunkDownloaderCustom::GetChecked()->DownloadChunks(ChunkIds, Callback, Priority, DownloadClass);
+}
+
+void UChunkDownloaderSubsystem::DownloadChunk(int32 ChunkId, FCallbackDelegate Callback, int32 Priority, FName DownloadClass)
+{
+	FChunkDownloaderCustom::GetChecked()->DownloadChunk(ChunkId, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); }, Priority, DownloadClass);
+}
+
+void UChunkDownloaderSubsystem::DownloadChunk(int32 ChunkId, FCallback Callback, int32 Priority, FName DownloadClass)
+{
+	FChunkDownloaderCustom::GetChecked()->DownloadChunk(ChunkId, Callback, Priority, DownloadClass);
+}
+
+void UChunkDownloaderSubsystem::DownloadChunkBefore(int32 ChunkId, FTimespan Deadline, FCallbackDelegate Callback, int32 Priority, FName DownloadClass)
+{
+	FChunkDownloaderCustom::GetChecked()->DownloadChunk(ChunkId, Deadline, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); }, Priority, DownloadClass);
+}
+
+void UChunkDownloaderSubsystem::DownloadChunkBefore(int32 ChunkId, FTimespan Deadline, FCallback Callback, int32 Priority, FName DownloadClass)
+{
+	FChunkDownloaderCustom::GetChecked()->DownloadChunk(ChunkId, Deadline, Callback, Priority, DownloadClass);
+}
+
+float UChunkDownloaderSubsystem::GetDownloadBandwidth() const
+{
+	return (float)FChunkDownloaderCustom::GetChecked()->GetDownloadBandwidth();
+}
+
+int32 UChunkDownloaderSubsystem::FlushCache()
+{
+	return FChunkDownloaderCustom::GetChecked()->FlushCache();
+}
+
+int32 UChunkDownloaderSubsystem::ValidateCache()
+{
+	return FChunkDownloaderCustom::GetChecked()->ValidateCache();
+}
+
+void UChunkDownloaderSubsystem::StartBackgroundInstall()
+{
+	FChunkDownloaderCustom::GetChecked()->StartBackgroundInstall();
+}
+
+void UChunkDownloaderSubsystem::StopBackgroundInstall()
+{
+	FChunkDownloaderCustom::GetChecked()->StopBackgroundInstall();
+}
+
+bool UChunkDownloaderSubsystem::IsBackgroundInstalling() const
+{
+	return FChunkDownloaderCustom::GetChecked()->IsBackgroundInstalling();
+}
+
+void UChunkDownloaderSubsystem::GetBackgroundInstallProgress(FBackgroundInstallProgress& Progress) const
+{
+	Progress = FChunkDownloaderCustom::GetChecked()->GetBackgroundInstallProgress();
+}
+
+void UChunkDownloaderSubsystem::BeginLoadingMode(FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->BeginLoadingMode([Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); });
+}
+
+void UChunkDownloaderSubsystem::BeginLoadingMode(FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->BeginLoadingMode(Callback);
+}
+
+void UChunkDownloaderSubsystem::GetLoadingStats(FChunkStats& Stats) const
+{
+	Stats = FChunkDownloaderCustom::GetChecked()->GetLoadingStats();
+}
+
+int32 UChunkDownloaderSubsystem::GetNumDownloadRequests() const
+{
+	return FChunkDownloaderCustom::GetChecked()->GetNumDownloadRequests();
+}
+
+bool UChunkDownloaderSubsystem::GetChunksForPackage(FName PackageName, TArray<int32>& OutChunkIds) const
+{
+	return FChunkDownloaderCustom::GetChecked()->GetChunksForPackage(PackageName, OutChunkIds);
+}
+
+void UChunkDownloaderSubsystem::ResolveChunkClosure(FName PackageName, FChunkIdsDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->ResolveChunkClosure(PackageName, [Callback](bool bSuccess, const TArray<int32>& ChunkIds) { Callback.ExecuteIfBound(bSuccess, ChunkIds); });
+}
+
+void UChunkDownloaderSubsystem::ResolveChunkClosure(FName PackageName, FChunkIdsCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->ResolveChunkClosure(PackageName, Callback);
+}
+
+void UChunkDownloaderSubsystem::AcquirePackage(FName PackageName, bool bPreScanAssets, FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->AcquirePackage(PackageName, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); }, bPreScanAssets);
+}
+
+void UChunkDownloaderSubsystem::AcquirePackage(FName PackageName, bool bPreScanAssets, FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->AcquirePackage(PackageName, Callback, bPreScanAssets);
+}
+
+void UChunkDownloaderSubsystem::PrewarmChunk(int32 ChunkId, const TArray<FName>& PackageNames, FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->PrewarmChunk(ChunkId, PackageNames, [Callback](int64 BytesRead, int64 BytesAdvised) { Callback.ExecuteIfBound(BytesRead >= 0); });
+}
+
+void UChunkDownloaderSubsystem::PrewarmChunk(int32 ChunkId, const TArray<FName>& PackageNames, FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->PrewarmChunk(ChunkId, PackageNames, [Callback](int64 BytesRead, int64 BytesAdvised)
+		{
+			if (Callback)
+			{
+				Callback(BytesRead >= 0);
+			}
+		});
+}
+
+void UChunkDownloaderSubsystem::PrepareLevel(TSoftObjectPtr<UWorld> Level, bool bPreScanAssets, FCallbackDelegate Callback)
+{
+	PrepareLevel(Level, bPreScanAssets, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); });
+}
+
+void UChunkDownloaderSubsystem::PrepareLevel(TSoftObjectPtr<UWorld> Level, bool bPreScanAssets, FCallback Callback)
+{
+	const FName PackageName = Level.ToSoftObjectPath().GetLongPackageFName();
+	const double StartTime = FPlatformTime::Seconds();
+
+	// the map package pulls in its whole dependency closure while it loads
+	TWeakObjectPtr<UChunkDownloaderSubsystem> WeakThis(this);
+	auto LoadLevel = [WeakThis, PackageName, StartTime, Callback]()
+	{
+		const double MountTime = FPlatformTime::Seconds() - StartTime;
+		::LoadPackageAsync(PackageName.ToString(), FLoadPackageAsyncDelegate::CreateLambda([WeakThis, StartTime, MountTime, Callback](const FName& LoadedPackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+			{
+				const bool bSuccess = (Result == EAsyncLoadingResult::Succeeded && Package != nullptr);
+				if (bSuccess && WeakThis.IsValid())
+				{
+					GatherPreparedLevelObjects(Package, WeakThis->PreparedLevels);
+				}
+				UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Level %s %s in %.1f ms (%.1f ms to mount)."), *LoadedPackageName.ToString(), bSuccess ? TEXT("prepared") : TEXT("failed to load"),
+					(FPlatformTime::Seconds() - StartTime) * 1000.0, MountTime * 1000.0);
+				if (Callback)
+				{
+					Callback(bSuccess);
+				}
+			}));
+	};
+
+	// levels that aren't in any chunk we know of may ship with the game, just load them
+	TArray<int32> ChunkIds;
+	TSharedRef<FChunkDownloaderCustom> ChunkDownloader = FChunkDownloaderCustom::GetChecked();
+	if (PackageName.IsNone() || !ChunkDownloader->GetChunksForPackage(PackageName, ChunkIds))
+	{
+		LoadLevel();
+		return;
+	}
+
+	// mount everything it needs in one go rather than finding out one load failure at a time
+	TWeakPtr<FChunkDownloaderCustom> WeakDownloader = ChunkDownloader;
+	ChunkDownloader->ResolveChunkClosure(PackageName, [WeakDownloader, bPreScanAssets, LoadLevel, Callback](bool bResolved, const TArray<int32>& ClosureChunkIds)
+		{
+			TSharedPtr<FChunkDownloaderCustom> SharedDownloader = WeakDownloader.Pin();
+			if (!bResolved || !SharedDownloader.IsValid())
+			{
+				if (Callback)
+				{
+					Callback(false);
+				}
+				return;
+			}
+			SharedDownloader->MountChunks(ClosureChunkIds, [LoadLevel, Callback](bool bSuccess)
+				{
+					if (bSuccess)
+					{
+						LoadLevel();
+					}
+					else if (Callback)
+					{
+						Callback(false);
+					}
+				}, bPreScanAssets);
+		});
+}
+
+void UChunkDownloaderSubsystem::ReleasePreparedLevels()
+{
+	PreparedLevels.Empty();
+}
+
+void UChunkDownloaderSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	// the map we traveled to is referenced by the world now, and holding on to the others would leak them across travels
+	PreparedLevels.Empty();
+}
+
+void UChunkDownloaderSubsystem::LoadPackageAsync(FName PackageName, FLoadPackageCallback Callback)
+{
+	::LoadPackageAsync(PackageName.ToString(), FLoadPackageAsyncDelegate::CreateLambda([WeakThis = TWeakObjectPtr<UChunkDownloaderSubsystem>(this), Callback](const FName& LoadedPackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+		{
+			if (Result == EAsyncLoadingResult::Succeeded || !WeakThis.IsValid())
+			{
+				if (Callback)
+				{
+					Callback(Result == EAsyncLoadingResult::Succeeded ? Package : nullptr);
+				}
+				return;
+			}
+
+			// the package may be in a chunk that isn't mounted yet
+			WeakThis->AcquirePackage(LoadedPackageName, false, [LoadedPackageName, Callback](bool bSuccess)
+				{
+					if (!bSuccess)
+					{
+						if (Callback)
+						{
+							Callback(nullptr);
+						}
+						return;
+					}
+					::LoadPackageAsync(LoadedPackageName.ToString(), FLoadPackageAsyncDelegate::CreateLambda([Callback](const FName&, UPackage* Package, EAsyncLoadingResult::Type Result)
+						{
+							if (Callback)
+							{
+								Callback(Result == EAsyncLoadingResult::Succeeded ? Package : nullptr);
+							}
+						}));
+				});
+		}));
+}
+
+int32 UChunkDownloaderSubsystem::ScanAssetsInChunk(int32 ChunkId)
+{
+	return FChunkDownloaderCustom::GetChecked()->ScanAssetsInChunk(ChunkId);
+}
+
+void UChunkDownloaderSubsystem::ScanAssetsInChunksAsync(const TArray<int32>& ChunkIds, FCallbackDelegate Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->ScanAssetsInChunksAsync(ChunkIds, [Callback](bool bSuccess) { Callback.ExecuteIfBound(bSuccess); });
+}
+
+void UChunkDownloaderSubsystem::ScanAssetsInChunksAsync(const TArray<int32>& ChunkIds, FCallback Callback)
+{
+	FChunkDownloaderCustom::GetChecked()->ScanAssetsInChunksAsync(ChunkIds, Callback);
+}
+
+bool UChunkDownloaderSubsystem::IsScanningAssets() const
+{
+	return FChunkDownloaderCustom::GetChecked()->IsScanningAssets();
+}
+
+void UChunkDownloaderSubsystem::GetChunkContentPaths(int32 ChunkId, TArray<FString>& Content, bool bCookedOnly)
+{
+	Content.Empty();
+	FChunkDownloaderCustom::GetChecked()->ForEachChunkFile(ChunkId, [&Content](const FChunkDownloaderCustom::FChunkFile& File)
+		{
+			Content.Add(File.Path);
+			return true;
+		}, bCookedOnly);
+}
+
+void UChunkDownloaderSubsystem::GetChunkContentPackageNames(int32 ChunkId, TArray<FString>& Content)
+{
+	Content.Empty();
+	FChunkDownloaderCustom::GetChecked()->ForEachChunkFile(ChunkId, [&Content](const FChunkDownloaderCustom::FChunkFile& File)
+		{
+			Content.Add(File.PackageName.ToString());
+			return true;
+		});
+}
+
+void UChunkDownloaderSubsystem::GetAssetsInChunk(int32 ChunkId, TArray<TSoftObjectPtr<UObject>>& Assets, bool bPreScanAssets, FName PackageName, FName PackagePath, bool bRecursivePath, TSubclassOf<UObject> Class, bool bRecursiveClass)
+{
+	FChunkDownloaderCustom::GetChecked()->GetChunkContent(ChunkId, Assets, bPreScanAssets, PackageName, PackagePath, bRecursivePath, Class, bRecursiveClass);
+}
+
+void UChunkDownloaderSubsystem::FindAssetInChunk(int32 ChunkId, TSoftObjectPtr<UObject>& Asset, bool bPreScanAssets, FName PackageName, FName PackagePath, bool bRecursivePath, TSubclassOf<UObject> Class, bool bRecursiveClass)
+{
+	TArray<TSoftObjectPtr<UObject>> Assets;
+	FChunkDownloaderCustom::GetChecked()->GetChunkContent(ChunkId, Assets, bPreScanAssets, PackageName, PackagePath, bRecursivePath, Class, bRecursiveClass);
+	Asset = Assets.Num() > 0 ? Assets[0] : nullptr;
+}
+
+
+
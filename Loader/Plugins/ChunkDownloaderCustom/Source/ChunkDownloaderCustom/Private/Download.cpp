@@ -12,6 +12,7 @@ FDownloadChunk::FDownloadChunk(const TSharedRef<FChunkDownloaderCustom>& Downloa
 	: Downloader(DownloaderIn)
 	, PakFile(PakFileIn)
 	, TargetFile(Downloader->CacheFolder / PakFileIn->Entry.FileName)
+	, TransferProgress(MakeShared<FTransferProgress, ESPMode::ThreadSafe>())
 {
 	// couple of sanity checks for our flags
 	check(!PakFile->bIsCached);
@@ -69,20 +70,22 @@ void FDownloadChunk::UpdateFileSize()
 	PakFile->SizeOnDisk = (FileSizeOnDisk > 0) ? (uint64)FileSizeOnDisk : 0;
 }
 
-bool FDownloadChunk::ValidateFile() const
+bool FDownloadChunk::ValidateFile(const FString& File, uint64 ExpectedSize, const FString& FileVersion)
 {
-	if (PakFile->SizeOnDisk != PakFile->Entry.FileSize)
+	// called from an I/O worker, so only looks at the file itself
+	const int64 SizeOnDisk = IFileManager::Get().FileSize(*File);
+	if (SizeOnDisk < 0 || (uint64)SizeOnDisk != ExpectedSize)
 	{
-		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Size mismatch. Expected %llu, got %llu"), PakFile->Entry.FileSize, PakFile->SizeOnDisk);
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Size mismatch. Expected %llu, got %lld"), ExpectedSize, SizeOnDisk);
 		return false;
 	}
 
-	if (PakFile->Entry.FileVersion.StartsWith(TEXT("SHA1:")))
+	if (FileVersion.StartsWith(TEXT("SHA1:")))
 	{
 		// check the sha1 hash
-		if (!FChunkDownloaderCustom::CheckFileSha1Hash(TargetFile, PakFile->Entry.FileVersion))
+		if (!FChunkDownloaderCustom::CheckFileSha1Hash(File, FileVersion))
 		{
-			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Checksum mismatch. Expected %s"), *PakFile->Entry.FileVersion);
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Checksum mismatch. Expected %s"), *FileVersion);
 			return false;
 		}
 	}
@@ -119,30 +122,54 @@ void FDownloadChunk::StartDownload(int TryNumber)
 	check(Downloader->BuildBaseUrls.Num() > 0);
 	FString Url = Downloader->BuildBaseUrls[TryNumber % Downloader->BuildBaseUrls.Num()] / PakFile->Entry.RelativeUrl;
 	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Downloading %s from %s"), *PakFile->Entry.FileName, *Url);
+
+	// the other threads only get copies and shared state, never the download or the downloader. The game thread
+	// picks up their progress and results once per frame (see FChunkDownloaderCustom::UpdateDownloads).
+	TransferProgress = MakeShared<FTransferProgress, ESPMode::ThreadSafe>();
+	TSharedRef<FTransferProgress, ESPMode::ThreadSafe> Progress = TransferProgress;
+	TSharedRef<FChunkDownloaderCustom::FDownloadResultQueue, ESPMode::ThreadSafe> Results = Downloader->DownloadResults;
 	TWeakPtr<FDownloadChunk> WeakThisPtr = AsShared();
-	CancelCallback = PlatformStreamDownloadChunk(Url, TargetFile, [WeakThisPtr](int32 BytesReceived) {
-		TSharedPtr<FDownloadChunk> SharedThis = WeakThisPtr.Pin();
-		if (SharedThis.IsValid() && !SharedThis->bHasCompleted)
-		{
-			SharedThis->OnDownloadProgress(BytesReceived);
-		}
-	}, [WeakThisPtr, TryNumber, Url](int32 HttpStatus) {
-		TSharedPtr<FDownloadChunk> SharedThis = WeakThisPtr.Pin();
-		if (SharedThis.IsValid() && !SharedThis->bHasCompleted)
-		{
-			SharedThis->OnDownloadComplete(Url, TryNumber, HttpStatus);
-		}
+	++Downloader->TransfersInFlight.FindOrAdd(PakFile->Entry.FileName);
+	CancelCallback = PlatformStreamDownloadChunk(Url, TargetFile, [Progress](int32 BytesReceived) {
+		Progress->BytesReceived.store(BytesReceived, std::memory_order_relaxed);
+	}, [Results, WeakThisPtr, TryNumber, Url, FileName = PakFile->Entry.FileName, File = TargetFile, FileSize = PakFile->Entry.FileSize, FileVersion = PakFile->Entry.FileVersion](int32 HttpStatus) {
+		// the file was just written on this I/O worker, hash it here as well
+		FChunkDownloaderCustom::FDownloadResult Result;
+		Result.Download = WeakThisPtr;
+		Result.FileName = FileName;
+		Result.Url = Url;
+		Result.TryNumber = TryNumber;
+		Result.HttpStatus = HttpStatus;
+		Result.bFileIsValid = EHttpResponseCodes::IsOk(HttpStatus) && ValidateFile(File, FileSize, FileVersion);
+		Results->Enqueue(MoveTemp(Result));
 	});
 }
 
 void FDownloadChunk::OnDownloadProgress(int32 BytesReceived)
 {
+	// bandwidth measurement (a retry starts over from 0)
+	if (BytesReceived > LastBytesReceived)
+	{
+		Downloader->TotalBytesReceived += BytesReceived - LastBytesReceived;
+	}
+
 	Downloader->LoadingModeStats.BytesDownloaded -= LastBytesReceived;
+	Downloader->DownloadRequestBytesRemaining += LastBytesReceived;
 	LastBytesReceived = BytesReceived;
 	Downloader->LoadingModeStats.BytesDownloaded += LastBytesReceived;
+	Downloader->DownloadRequestBytesRemaining -= LastBytesReceived;
+}
+
+void FDownloadChunk::UpdateProgress()
+{
+	const int32 BytesReceived = TransferProgress->BytesReceived.load(std::memory_order_relaxed);
+	if (BytesReceived != LastBytesReceived && !bHasCompleted)
+	{
+		OnDownloadProgress(BytesReceived);
+	}
 }
 
-void FDownloadChunk::OnDownloadComplete(const FString& Url, int TryNumber, int32 HttpStatus)
+void FDownloadChunk::OnDownloadComplete(const FString& Url, int32 TryNumber, int32 HttpStatus, bool bFileIsValid)
 {
 	// only handle completion once
 	check(!bHasCompleted);
@@ -159,10 +186,16 @@ void FDownloadChunk::OnDownloadComplete(const FString& Url, int TryNumber, int32
 	// handle success
 	if (EHttpResponseCodes::IsOk(HttpStatus))
 	{
-		// make sure the file is complete
-		if (ValidateFile())
+		// the I/O worker made sure the file is complete
+		if (bFileIsValid)
 		{
 			PakFile->bIsCached = true;
+
+			// ValidateFile already checked the hash, no need to do it again before mounting
+			if (FChunkDownloaderCustom::CanVerifyPakFile(*PakFile))
+			{
+				Downloader->MarkPakFileVerified(*PakFile);
+			}
 			OnCompleted(true, FText());
 			return;
 		}
@@ -220,12 +253,22 @@ void FDownloadChunk::OnCompleted(bool bSuccess, const FText& ErrorText)
 	}
 	PakFile->PostDownloadCallbacks.Empty();
 
+	// whoever needed it by then has been answered
+	PakFile->Deadline = FDateTime::MaxValue();
+	PakFile->bDeadlineAtRisk = false;
+	PakFile->DownloadClass = NAME_None;
+	PakFile->Priority = 0;
+
 	// remove from download requests
 	if (ensure(Downloader->DownloadRequests.RemoveSingle(PakFile) > 0))
 	{
+		Downloader->DownloadRequestBytesRemaining -= PakFile->Entry.FileSize - LastBytesReceived;
 		Downloader->IssueDownloads();
 	}
 
+	// the chunk status will need to be recomputed
+	Downloader->InvalidateChunkStatus(*PakFile);
+
 	// unhook from pak file (this may delete us)
 	if (PakFile->Download.Get() == this)
 	{
@@ -4,6 +4,7 @@
 
 #include "ChunkDownloader.h"
 #include "PlatformStreamDownload.h"
+#include <atomic>
 
 class FDownloadChunk : public TSharedFromThis<FDownloadChunk>
 {
@@ -17,6 +18,10 @@ public:
 	void Start();
 	void Cancel(bool bResult);
 
+	// called by the downloader on the game thread, with what the HTTP and I/O threads left for us
+	void UpdateProgress();
+	void OnDownloadComplete(const FString& Url, int32 TryNumber, int32 HttpStatus, bool bFileIsValid);
+
 public:
 	const TSharedRef<FChunkDownloaderCustom> Downloader;
 	const TSharedRef<FChunkDownloaderCustom::FPakFileRecord> PakFile;
@@ -24,19 +29,26 @@ public:
 
 protected:
 	void UpdateFileSize();
-	bool ValidateFile() const;
+	static bool ValidateFile(const FString& File, uint64 ExpectedSize, const FString& FileVersion);
 	bool HasDeviceSpaceRequired() const;
 	void StartDownload(int TryNumber);
 	void OnDownloadProgress(int32 BytesReceived);
-	void OnDownloadComplete(const FString& Url, int TryNumber, int32 HttpStatus);
 	void OnCompleted(bool bSuccess, const FText& ErrorText);
 
+	// written by the HTTP thread, shared so that it never has to hold on to the download itself.
+	// one per try, so a late progress callback from a previous try can't overwrite the count of the next one.
+	struct FTransferProgress
+	{
+		std::atomic<int32> BytesReceived{ 0 };
+	};
+
 private:
 	bool bIsCancelled = false;
 	FDownloadCancel CancelCallback;
 	bool bHasCompleted = false;
 	FDateTime BeginTime;
 	int32 LastBytesReceived = 0;
+	TSharedRef<FTransferProgress, ESPMode::ThreadSafe> TransferProgress;
 };
 
 #if UE_ENABLE_INCLUDE_ORDER_DEPRECATED_IN_5_2
@@ -11,6 +11,8 @@ typedef TFunction<void(int32 HttpStatus)> FDownloadComplete;
 typedef TFunction<void(int32 BytesReceived)> FDownloadProgress;
 typedef TFunction<void(void)> FDownloadCancel;
 
+// Progress is called from the HTTP thread and Callback from an I/O worker once the file is written, neither on the game thread.
+// Callback is called for canceled transfers as well (with HttpStatus 0), once the worker is done with TargetFile.
 extern FDownloadCancel PlatformStreamDownloadChunk(const FString& Url, const FString& TargetFile, const FDownloadProgress& Progress, const FDownloadComplete& Callback);
 
 #if UE_ENABLE_INCLUDE_ORDER_DEPRECATED_IN_5_2
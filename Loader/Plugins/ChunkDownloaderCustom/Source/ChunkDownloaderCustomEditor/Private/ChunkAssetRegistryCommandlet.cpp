@@ -0,0 +1,117 @@
+#include "ChunkAssetRegistryCommandlet.h"
+#include "AssetRegistry/AssetRegistryState.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/ArrayWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogChunkAssetRegistry, Log, All);
+
+int32 UChunkAssetRegistryCommandlet::Main(const FString& Params)
+{
+	FString RegistryFile;
+	FString ContentFile;
+	FString ChunkList;
+	FString OutDir;
+	if (!FParse::Value(*Params, TEXT("Registry="), RegistryFile) ||
+		!FParse::Value(*Params, TEXT("Content="), ContentFile) ||
+		!FParse::Value(*Params, TEXT("Chunks="), ChunkList, false) ||
+		!FParse::Value(*Params, TEXT("OutDir="), OutDir))
+	{
+		UE_LOG(LogChunkAssetRegistry, Error, TEXT("Usage: -run=ChunkAssetRegistry -Registry=<AssetRegistry.bin> -Content=<listing> -Chunks=<id,id,...> -OutDir=<dir>"));
+		return 1;
+	}
+
+	// chunks to write a fragment for
+	TMap<int32, TSet<FName>> ChunkPackages;
+	TArray<FString> ChunkIds;
+	ChunkList.ParseIntoArray(ChunkIds, TEXT(","));
+	for (const FString& ChunkId : ChunkIds)
+	{
+		ChunkPackages.Add(FCString::Atoi(*ChunkId));
+	}
+
+	// the packages in each of them
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *ContentFile))
+	{
+		UE_LOG(LogChunkAssetRegistry, Error, TEXT("Unable to read content listing '%s'."), *ContentFile);
+		return 1;
+	}
+	for (const FString& Line : Lines)
+	{
+		FString ChunkId;
+		FString PackageName;
+		if (Line.StartsWith(TEXT("$")) || !Line.Split(TEXT("\t"), &ChunkId, &PackageName))
+		{
+			continue;
+		}
+		if (TSet<FName>* Packages = ChunkPackages.Find(FCString::Atoi(*ChunkId)))
+		{
+			Packages->Add(FName(*PackageName));
+		}
+	}
+
+	FAssetRegistryState State;
+	if (!FAssetRegistryState::LoadFromDisk(*RegistryFile, FAssetRegistryLoadOptions(), State))
+	{
+		UE_LOG(LogChunkAssetRegistry, Error, TEXT("Unable to load asset registry '%s'."), *RegistryFile);
+		return 1;
+	}
+
+	// keep everything the runtime merges when the chunk mounts
+	FAssetRegistrySerializationOptions Options;
+	Options.bSerializeAssetRegistry = true;
+	Options.bSerializeDependencies = true;
+	Options.bSerializePackageData = true;
+	const UE::AssetRegistry::FDependencyQuery HardDependencies(UE::AssetRegistry::EDependencyQuery::Hard);
+	for (const auto& It : ChunkPackages)
+	{
+		// pruning drops the depends nodes of every package it doesn't keep, and the edges pointing at them with it,
+		// so keep the direct hard dependencies too (the cross-chunk ones are what ResolveChunkClosure follows)
+		TSet<FName> RequiredPackages = It.Value;
+		TSet<FName> DependencyPackages;
+		TArray<FAssetIdentifier> Dependencies;
+		for (const FName& PackageName : It.Value)
+		{
+			Dependencies.Reset();
+			State.GetDependencies(FAssetIdentifier(PackageName), Dependencies, UE::AssetRegistry::EDependencyCategory::Package, HardDependencies);
+			for (const FAssetIdentifier& Dependency : Dependencies)
+			{
+				if (!Dependency.PackageName.IsNone() && !It.Value.Contains(Dependency.PackageName))
+				{
+					DependencyPackages.Add(Dependency.PackageName);
+				}
+			}
+		}
+		RequiredPackages.Append(DependencyPackages);
+
+		FAssetRegistryState ChunkState;
+		ChunkState.InitializeFromExisting(State, Options);
+		ChunkState.PruneAssetData(RequiredPackages, TSet<FName>(), Options);
+
+		// then drop what they add besides their depends nodes, their assets belong to the fragments of their own chunks
+		for (const FName& PackageName : DependencyPackages)
+		{
+			TArray<const FAssetData*> PackageAssets(ChunkState.GetAssetsByPackageName(PackageName));
+			for (const FAssetData* AssetData : PackageAssets)
+			{
+				bool bRemovedAssetData = false;
+				bool bRemovedPackageData = false;
+				ChunkState.RemoveAssetData(const_cast<FAssetData*>(AssetData), false, bRemovedAssetData, bRemovedPackageData);
+			}
+			ChunkState.RemovePackageData(PackageName);
+		}
+
+		FArrayWriter Writer;
+		ChunkState.Save(Writer, Options);
+		const FString OutFile = OutDir / FString::Printf(TEXT("chunk%d-AssetRegistry.bin"), It.Key);
+		if (!FFileHelper::SaveArrayToFile(Writer, *OutFile))
+		{
+			UE_LOG(LogChunkAssetRegistry, Error, TEXT("Unable to write '%s'."), *OutFile);
+			return 1;
+		}
+		UE_LOG(LogChunkAssetRegistry, Display, TEXT("Wrote %s (%d packages, %d assets, %d dependencies outside the chunk)."), *OutFile, It.Value.Num(), ChunkState.GetNumAssets(), DependencyPackages.Num());
+	}
+	return 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "ChunkAssetRegistryCommandlet.generated.h"
+
+// Splits the cooked AssetRegistry.bin of a project into one chunk<N>-AssetRegistry.bin per chunk, each describing only the packages
+// in that chunk, so a chunk doesn't download (and merge) the registry of the whole project. BuildPakFiles.js runs it on the source project:
+//   UnrealEditor-Cmd <project> -run=ChunkAssetRegistry -Registry=<AssetRegistry.bin> -Content=<listing> -Chunks=<id,id,...> -OutDir=<dir>
+// where the listing has a "<chunk id>\t<package name>" line per package (the format of the ChunkContent listing).
+UCLASS()
+class UChunkAssetRegistryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	virtual int32 Main(const FString& Params) override;
+};
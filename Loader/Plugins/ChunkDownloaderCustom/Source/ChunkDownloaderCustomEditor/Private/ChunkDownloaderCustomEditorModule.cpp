@@ -0,0 +1,6 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Modules/ModuleManager.h"
+
+// build tools only (see UChunkAssetRegistryCommandlet), kept out of the runtime module so they don't ship with the game
+IMPLEMENT_MODULE(FDefaultModuleImpl, ChunkDownloaderCustomEditor);
@@ -2,6 +2,7 @@
 const fs = require('fs');
 const path = require('path');
 const crypto = require('crypto');
+const child_process = require('child_process');
 
 let makeDir = function(dir)
 {
@@ -24,7 +25,49 @@ let getChecksum = function(file, type, callback)
 	});
 };
 
-let copyBuildFiles = function(BuildBaseDir, CdnBaseDir, OnComplete)
+let writeAssetRegistryFragments = function(AssetRegistry, ChunkIds, OutDir)
+{
+	// each chunk ships the part of the cooked registry describing its own packages, not the whole project
+	if (!AssetRegistry)
+		return;
+	let chunkIds = ChunkIds.filter((chunkId) => {
+		let destFile = path.resolve(OutDir, `chunk${chunkId}-AssetRegistry.bin`);
+		if (!fs.existsSync(destFile))
+			return true;
+		console.log(`Skipping ${destFile} (already present)`);
+		return false;
+	});
+	if (chunkIds.length <= 0)
+		return;
+
+	// the registry is cooked to <project dir>/Saved/Cooked/<platform>/<project name>/AssetRegistry.bin
+	const CookedDir = path.dirname(AssetRegistry.file);
+	const ProjectFile = path.resolve(CookedDir, "../../../..", `${path.basename(CookedDir)}.uproject`);
+
+	// list which chunk each package is in (same format as the content listing)
+	let listFileName = path.resolve(OutDir, "ChunkContent.tmp");
+	let listFile = fs.openSync(listFileName, "w");
+	for (let entry of readPakLists(AssetRegistry.pakLists))
+	{
+		fs.writeSync(listFile, `${entry.chunk}\t${entry.name}\n`);
+	}
+	fs.closeSync(listFile);
+
+	// the editor does the actual filtering (see UChunkAssetRegistryCommandlet)
+	console.log(`Splitting ${AssetRegistry.file} for ${chunkIds.length} chunks...`);
+	child_process.execFileSync(AssetRegistry.editorCmd, [
+		ProjectFile,
+		"-run=ChunkAssetRegistry",
+		`-Registry=${AssetRegistry.file}`,
+		`-Content=${listFileName}`,
+		`-Chunks=${chunkIds.join(",")}`,
+		`-OutDir=${OutDir}`,
+		"-unattended", "-nop4", "-nosplash", "-stdout",
+	], { stdio: "inherit" });
+	fs.unlinkSync(listFileName);
+};
+
+let copyBuildFiles = function(BuildBaseDir, CdnBaseDir, AssetRegistry, OnComplete)
 {
 	// figure out the build id
 	const BuilderBuildId = path.basename(BuildBaseDir);
@@ -88,6 +131,7 @@ let copyBuildFiles = function(BuildBaseDir, CdnBaseDir, OnComplete)
 		let outDir = path.resolve(CdnOutputDir, outPlatform);
 		makeDir(outDir);
 
+		let chunkIds = [];
 		for (let chunkFile of fs.readdirSync(platformDir))
 		{
 			// parse out the chunk id
@@ -98,6 +142,9 @@ let copyBuildFiles = function(BuildBaseDir, CdnBaseDir, OnComplete)
 			let chunkId = parseInt(m[1]);
 			let chunkDir = path.resolve(platformDir, chunkFile);
 
+			// gets a serialized asset registry below
+			chunkIds.push(chunkId);
+
 			// ordered list of files in this dir
 			let pakFileList = fs.readdirSync(chunkDir);
 			pakFileList.sort();
@@ -127,6 +174,9 @@ let copyBuildFiles = function(BuildBaseDir, CdnBaseDir, OnComplete)
 				});
 			}
 		}
+
+		// serialized asset registry for each chunk
+		writeAssetRegistryFragments(AssetRegistry, chunkIds, outDir);
 	}
 
 	// counteract the 1 we added (helps us fire onComplete when there are 0 queued)
@@ -192,7 +242,7 @@ let generateManifests = function(CdnStageDir)
 		for (let pakFile of fs.readdirSync(platformDir))
 		{
 			// parse out the chunk id
-			let m = pakFile.match(/chunk([0-9]+)-pak[0-9]+\.pak/);
+			let m = pakFile.match(/chunk([0-9]+)-(pak[0-9]+\.pak|AssetRegistry\.bin)$/);
 			if (m === null)
 				continue;
 			let chunkId = parseInt(m[1]);
@@ -227,6 +277,93 @@ let generateManifests = function(CdnStageDir)
 	}
 }
 
+let getPackageName = function(PakPath)
+{
+	// same mapping as the runtime uses for pak mount points: "../../../<Project>/Content/<etc>" is "/Game/<etc>"
+	// and "../../../<Project>/Plugins/<Plugin>/Content/<etc>" is "/<Plugin>/<etc>". Only cooked assets are listed.
+	let m = PakPath.match(/^\.\.\/\.\.\/\.\.\/[^\/]+\/(.*)\.(uasset|umap)$/);
+	if (m === null)
+		return null;
+	let pm = m[1].match(/^Plugins\/([^\/]+)\/Content\/(.*)$/);
+	if (pm !== null)
+		return `/${pm[1]}/${pm[2]}`;
+	let cm = m[1].match(/^Content\/(.*)$/);
+	if (cm !== null)
+		return `/Game/${cm[1]}`;
+	return null;
+};
+
+let readPakLists = function(ListingsDir)
+{
+	// read the pak list response files written when packaging (e.g. Saved/TmpPackaging/Windows/pakchunk1.txt)
+	let entries = [];
+	for (let listFile of fs.readdirSync(ListingsDir))
+	{
+		let m = listFile.match(/^pakchunk([0-9]+).*\.txt$/);
+		if (m === null)
+			continue;
+		let chunkId = parseInt(m[1]);
+
+		// each line is "<cooked file>" "<path in pak>" [options]
+		let packages = new Set();
+		for (let line of fs.readFileSync(path.resolve(ListingsDir, listFile), 'utf8').split(/\r?\n/))
+		{
+			let fields = line.match(/"([^"]*)"/g);
+			if (fields === null || fields.length < 2)
+				continue;
+			let packageName = getPackageName(fields[1].slice(1, -1));
+			if (packageName !== null)
+				packages.add(packageName);
+		}
+		for (let packageName of packages)
+			entries.push({ chunk: chunkId, name: packageName });
+	}
+	return entries;
+};
+
+let generateContentListing = function(CdnStageDir, Platform, ListingsDir)
+{
+	// figure out the buildId from CdnStageDir
+	let buildId = path.basename(CdnStageDir);
+
+	let entries = readPakLists(ListingsDir);
+
+	// sort by chunk id
+	entries.sort(function(a, b) {
+		if (a.chunk === b.chunk)
+			return a.name.localeCompare(b.name);
+		return a.chunk < b.chunk ? -1 : 1;
+	});
+
+	// sync write next to the build manifest
+	let fileName = path.resolve(CdnStageDir, `ChunkContent-${Platform}.txt`);
+	let listing = fs.openSync(fileName, "w");
+	fs.writeSync(listing, `$BUILD_ID = ${buildId}\n`);
+	fs.writeSync(listing, `$NUM_ENTRIES = ${entries.length}\n`);
+	for (let entry of entries)
+	{
+		fs.writeSync(listing, `${entry.chunk}\t${entry.name}\n`);
+	}
+	fs.closeSync(listing);
+	console.log("wrote", fileName);
+};
+
+let getAssetRegistryArgs = function(FirstArg)
+{
+	// optional <asset_registry_bin> <pak_lists> <editor_cmd>
+	if (!process.argv[FirstArg])
+		return null;
+	if (!process.argv[FirstArg + 1])
+		throw new Error('Missing PakListsDir argument');
+	if (!process.argv[FirstArg + 2])
+		throw new Error('Missing EditorCmd argument');
+	return {
+		file: path.resolve(process.argv[FirstArg]),
+		pakLists: path.resolve(process.argv[FirstArg + 1]),
+		editorCmd: process.argv[FirstArg + 2],
+	};
+};
+
 let operation = process.argv[2] || "help";
 if (operation === "process")
 {
@@ -237,9 +374,10 @@ if (operation === "process")
 
 	const BuildBaseDir = path.resolve(process.argv[3]);
 	const CdnBaseDir = path.resolve(process.argv[4]);
+	const AssetRegistry = getAssetRegistryArgs(5);
 
 	// copy the build
-	copyBuildFiles(BuildBaseDir, CdnBaseDir, (CdnStageDir) => {
+	copyBuildFiles(BuildBaseDir, CdnBaseDir, AssetRegistry, (CdnStageDir) => {
 		// then generate manifests
 		generateManifests(CdnStageDir);
 	});
@@ -255,7 +393,8 @@ else if (operation === "move")
 	// just copy the build
 	const BuildBaseDir = path.resolve(process.argv[3]);
 	const CdnBaseDir = path.resolve(process.argv[4]);
-	copyBuildFiles(BuildBaseDir, CdnBaseDir);
+	const AssetRegistry = getAssetRegistryArgs(5);
+	copyBuildFiles(BuildBaseDir, CdnBaseDir, AssetRegistry);
 }
 else if (operation === "manifest")
 {
@@ -266,10 +405,28 @@ else if (operation === "manifest")
 	const CdnStageDir = path.resolve(process.argv[3]);
 	generateManifests(CdnStageDir);
 }
+else if (operation === "content")
+{
+	if (!process.argv[3])
+		throw new Error('Missing CdnStageDir argument');
+	if (!process.argv[4])
+		throw new Error('Missing Platform argument');
+	if (!process.argv[5])
+		throw new Error('Missing ListingsDir argument');
+
+	// just generate the content listing
+	const CdnStageDir = path.resolve(process.argv[3]);
+	const ListingsDir = path.resolve(process.argv[5]);
+	generateContentListing(CdnStageDir, process.argv[4], ListingsDir);
+}
 else
 {
 	// help or invalid params
-	console.log("process <build_source> <cdn_stage> // does both a move and manifest generation");
-	console.log("move <build_source> <cdn_stage> // copy pak files from a build, rename then, and organize for CDN");
+	console.log("process <build_source> <cdn_stage> [asset_registry_bin pak_lists editor_cmd] // does both a move and manifest generation");
+	console.log("move <build_source> <cdn_stage> [asset_registry_bin pak_lists editor_cmd] // copy pak files from a build, rename then, and organize for CDN");
+	console.log("    asset_registry_bin: cooked AssetRegistry.bin of the source project (e.g. Map/Saved/Cooked/Windows/PakMap/AssetRegistry.bin), split so each chunk ships the part describing its packages");
+	console.log("    pak_lists: the pakchunk*.txt files written when packaging (e.g. Map/Saved/TmpPackaging/Windows)");
+	console.log("    editor_cmd: UnrealEditor-Cmd executable used to split the registry, on the source project");
 	console.log("manifest <cdn_stage>/<build> // generate manifests for a CDN prep folder");
+	console.log("content <cdn_stage>/<build> <platform> <pak_lists> // list which chunk each package is in, from the pakchunk*.txt files written when packaging (e.g. Map/Saved/TmpPackaging/Windows)");
 }
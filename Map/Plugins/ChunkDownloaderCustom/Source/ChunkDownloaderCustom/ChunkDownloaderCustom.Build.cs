@@ -14,6 +14,7 @@ public class ChunkDownloaderCustom : ModuleRules
 				"Engine",
                 "HTTP",
 				"PakFile",
+				"AssetRegistry",
 			}
 		);
 		PrivateIncludePathModuleNames.AddRange(
@@ -0,0 +1,5876 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ChunkDownloader.h"
+#include "ChunkDownloaderLog.h"
+#include "Async/AsyncWork.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HttpModule.h"
+#include "Misc/CoreDelegates.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Misc/SecureHash.h"
+#include "Misc/AES.h"
+#include "Serialization/MemoryReader.h"
+#include "Misc/FileHelper.h"
+#include "Math/RandomStream.h"
+#include "Interfaces/IHttpResponse.h"
+#include "UObject/UObjectGlobals.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Download.h"
+#include "Modules/ModuleManager.h"
+#include "IPlatformFilePak.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/AssetRegistryState.h"
+#include "String/ParseLines.h"
+#include "Misc/PackageName.h"
+#if PLATFORM_ANDROID || PLATFORM_IOS
+#include "HAL/PlatformApplicationMisc.h"
+#endif
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define LOCTEXT_NAMESPACE "ChunkDownloaderCustom"
+
+static const FString EMBEDDED_MANIFEST = TEXT("EmbeddedManifest.txt");
+static const FString LOCAL_MANIFEST = TEXT("LocalManifest.txt");
+static const FString CACHED_BUILD_MANIFEST = TEXT("CachedBuildManifest.txt");
+static const FString VERIFIED_MANIFEST = TEXT("VerifiedManifest.txt");
+static const FString CACHED_CONTENT_LISTING = TEXT("CachedChunkContent.txt");
+static const FString CHUNK_TRANSITIONS = TEXT("ChunkTransitions.txt");
+static const FString DEFAULT_DOWNLOAD_CLASS = TEXT("Default");
+static const FName PREFETCH_DOWNLOAD_CLASS = TEXT("Prefetch");
+static const FName BACKGROUND_INSTALL_DOWNLOAD_CLASS = TEXT("BackgroundInstall");
+static const FString BACKGROUND_INSTALL_MARKER = TEXT("BackgroundInstall.txt");
+static const FString BUILD_ID_KEY = TEXT("BUILD_ID");
+static const FString SCRUB_CURSOR_KEY = TEXT("SCRUB_CURSOR");
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class FChunkDownloaderCustom::FMultiCallback
+{
+public:
+	FMultiCallback(const FCallback& Callback)
+		: OuterCallback(Callback)
+	{
+		IndividualCb = [this](bool bSuccess) {
+			// update stats
+			--NumPending;
+			if (bSuccess)
+				++NumSucceeded;
+			else
+				++NumFailed;
+
+			// if we're the last one, trigger the outer callback
+			if (NumPending <= 0)
+			{
+				check(NumPending == 0);
+				if (OuterCallback)
+				{
+					OuterCallback(NumFailed <= 0);
+				}
+
+				// done with this
+				delete this;
+			}
+		};
+	}
+
+	inline const FCallback& AddPending()
+	{ 
+		++NumPending;
+		return IndividualCb;
+	}
+
+	inline int32 GetNumPending() const { return NumPending; }
+
+	void Abort()
+	{
+		check(NumPending == 0);
+		delete this;
+	}
+
+private:
+	~FMultiCallback() {}
+
+	int32 NumPending = 0;
+	int32 NumSucceeded = 0;
+	int32 NumFailed = 0;
+	FCallback IndividualCb;
+	FCallback OuterCallback;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+struct FChunkDownloaderCustom::FGameThreadWork
+{
+	struct FItem
+	{
+		const TCHAR* Name = nullptr;
+		uint64 Frame = 0;
+		TUniqueFunction<void()> Work;
+	};
+
+	// starts over every frame. The first item of a frame always fits, so work always progresses.
+	bool HasBudget()
+	{
+		if (Frame != GFrameCounter)
+		{
+			Frame = GFrameCounter;
+			FrameMs = 0.0;
+			bFrameWorked = false;
+		}
+		return FrameMs < FrameBudgetMs;
+	}
+
+	void Record(const TCHAR* Name, double StartTime)
+	{
+		HasBudget();
+		const double ItemMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		const bool bWasWithinBudget = FrameMs <= FrameBudgetMs;
+		FrameMs += ItemMs;
+
+		if (!bFrameWorked)
+		{
+			bFrameWorked = true;
+			++Stats.NumFrames;
+		}
+		Stats.TotalMs += ItemMs;
+		Stats.MaxFrameMs = FMath::Max(Stats.MaxFrameMs, FrameMs);
+		if (ItemMs > Stats.MaxItemMs)
+		{
+			Stats.MaxItemMs = ItemMs;
+			Stats.MaxItemName = Name;
+		}
+
+		// a single item can't be split, so report what caused the hitch
+		if (bWasWithinBudget && FrameMs > FrameBudgetMs)
+		{
+			++Stats.NumFramesOverBudget;
+			UE_LOG(LogChunkDownloaderCustom, Verbose, TEXT("Game thread work over its frame budget (%.2f ms of %.2f ms), %s took %.2f ms."), FrameMs, FrameBudgetMs, Name, ItemMs);
+		}
+		if (ItemMs > FrameBudgetMs)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("%s took %.2f ms on the game thread (frame budget is %.2f ms)."), Name, ItemMs, FrameBudgetMs);
+		}
+	}
+
+	bool Tick()
+	{
+		// only what was queued before this frame, so deferred callbacks never run in the frame that queued them
+		int32 NumDone = 0;
+		for (FItem* Item = Items.Peek(); Item != nullptr && Item->Frame < GFrameCounter && (NumDone == 0 || HasBudget()); Item = Items.Peek())
+		{
+			FItem Next;
+			Items.Dequeue(Next);
+			--NumItems;
+
+			const double StartTime = FPlatformTime::Seconds();
+			Next.Work();
+			Record(Next.Name, StartTime);
+			++NumDone;
+		}
+
+		FItem* Item = Items.Peek();
+		if (Item != nullptr && Item->Frame < GFrameCounter)
+		{
+			++Stats.NumFramesDeferred;
+		}
+
+		if (NumItems <= 0)
+		{
+			Ticker.Reset();
+			return false;
+		}
+		return true; // keep ticking
+	}
+
+	TQueue<FItem> Items;
+	int32 NumItems = 0;
+	FTSTicker::FDelegateHandle Ticker;
+
+	// the budget is spent by deferred work and mount completions alike
+	double FrameBudgetMs = 2.0;
+	uint64 Frame = 0;
+	double FrameMs = 0.0;
+	bool bFrameWorked = false;
+	FGameThreadWorkStats Stats;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+FChunkDownloaderCustom::FPakMountWorkResult::FPakMountWorkResult(FPakFile* Pak)
+	: Pak(Pak) 
+{}
+
+class FChunkDownloaderCustom::FPakMountWork : public FNonAbandonableTask
+{
+public:
+	friend class FAsyncTask<FPakMountWork>;
+
+	void DoWork()
+	{
+		if (!bIsUnmountTask)
+		{
+			// try to mount the pak files
+			if (FCoreDelegates::MountPak.IsBound())
+			{
+				// opening a pak and parsing its index is the expensive part, do it for all of them in parallel (without mounting them).
+				// that's also where they get sampled and indexed, so a pak failing verification is never mounted at all.
+				TArray<FOpenedPak> OpenedPaks;
+				OpenedPaks.SetNum(PakFiles.Num());
+				ParallelFor(PakFiles.Num(), [this, &OpenedPaks](int32 Index)
+				{
+					OpenPakFile(PakFiles[Index], OpenedPaks[Index]);
+				});
+
+				// then mount and register them in order on this thread, same as if they had been mounted one by one
+				// (the pak platform file finds their index in the OS file cache by now)
+				for (int i(0), j(PakFiles.Num() - 1); i <= j; i++)
+				{
+					const TSharedRef<FPakFileRecord>& PakFile = PakFiles[i];
+					FOpenedPak& Opened = OpenedPaks[i];
+
+					if (Opened.bFailedVerification)
+					{
+						FailedPakFiles.Add(PakFile);
+						continue;
+					}
+
+					FPakFile* Pak = MountPakFile(Opened.FullPathOnDisk, PakFiles.Num() - i);
+					if (Pak)
+					{
+						FPakMountWorkResult Result(Pak);
+						Result.VerifyStatus = Opened.VerifyStatus;
+						Result.Content = MoveTemp(Opened.Content);
+
+						// does this pak need to register the mount point?
+						if (!bDeferRegistration)
+						{
+							Result.IsRegistered = RegisterPakMountPoint(Pak->GetMountPoint(), Opened.FullPathOnDisk, ChunkId);
+						}
+
+						// record that we successfully mounted this pak file
+						ProcessedPakFiles.Add(PakFile, Result);
+					}
+					else
+					{
+						UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to mount %s from chunk %d (mount operation failed)"), *Opened.FullPathOnDisk, ChunkId);
+					}
+				}
+			}
+			else
+			{
+				UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to mount chunk %d (no FCoreDelegates::MountPak bound)"), ChunkId);
+			}
+
+			// load the chunk's serialized asset registry once everything is mounted, the game thread merges it if assets get scanned
+			if (RegistryFragmentFile.IsValid() && FailedPakFiles.Num() <= 0 && ProcessedPakFiles.Num() == PakFiles.Num())
+			{
+				LoadRegistryFragment();
+			}
+		}
+		else
+		{
+
+			// try to unmount the pak files (in reverse order)
+			if (ensure(FCoreDelegates::OnUnmountPak.IsBound()))
+			{
+				for (int i(PakFiles.Num() - 1), j(0); i >= j; i--)
+				{
+					const TSharedRef<FPakFileRecord>& PakFile = PakFiles[i];
+
+					FString FullPathOnDisk = (PakFile->bIsEmbedded ? EmbeddedFolder : CacheFolder) / PakFile->Entry.FileName;
+					TRefCountPtr<FPakFile> UnmountedPak = PakFile->Pak.GetReference();
+
+					if (ensure(FCoreDelegates::OnUnmountPak.Execute(FullPathOnDisk)))
+					{
+						FPakMountWorkResult Result(UnmountedPak);
+
+						// pak file was registered to the file system when mounted
+						if (PakFile->IsRegistered == ERegistryStatus::Registered)
+						{
+							FString MountPoint = UnmountedPak->GetMountPoint();
+							FPackageName::UnRegisterMountPoint(GetRootDir(MountPoint), MountPoint);
+						}
+
+						// record that we successfully unmounted this pak file
+						ProcessedPakFiles.Add(PakFile, Result);
+
+					}
+					else
+					{
+						UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to unmount %s"), *FullPathOnDisk);
+					}
+				}
+			}
+			else
+			{
+				UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to unmount chunk %d (no FCoreDelegates::OnUnmountPak bound)"), ChunkId);
+			}
+		}
+
+		// let the game thread know we're done
+		CompletionQueue->Enqueue(TaskId);
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FPakMountWork, STATGROUP_ThreadPoolAsyncTasks);
+	}
+
+private:
+
+	struct FOpenedPak
+	{
+		FString FullPathOnDisk;
+		EVerifyStatus VerifyStatus = EVerifyStatus::Unverified;
+		bool bFailedVerification = false;
+		FContentIndex Content;
+	};
+
+	static FPakFile* MountPakFile(const FString& FullPathOnDisk, uint32 PakReadOrder)
+	{
+		FPakFile* Pak = (FPakFile*)FCoreDelegates::MountPak.Execute(FullPathOnDisk, PakReadOrder);
+
+#if !UE_BUILD_SHIPPING
+		if (!Pak)
+		{
+			// This can fail because of the sandbox system - which the pak system doesn't understand.
+			FString SandboxedPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*FullPathOnDisk);
+			Pak = (FPakFile*)FCoreDelegates::MountPak.Execute(SandboxedPath, PakReadOrder);
+		}
+#endif
+		return Pak;
+	}
+
+	// open a single pak on its own and parse its index, without mounting it (safe to call for several paks at once)
+	static TRefCountPtr<FPakFile> OpenUnmountedPakFile(const FString& FullPathOnDisk)
+	{
+		FPakPlatformFile* PakPlatformFile = (FPakPlatformFile*)FPlatformFileManager::Get().FindPlatformFile(FPakPlatformFile::GetTypeName());
+		IPlatformFile* LowerLevel = (PakPlatformFile != nullptr) ? PakPlatformFile->GetLowerLevel() : &IPlatformFile::GetPlatformPhysical();
+		TRefCountPtr<FPakFile> Pak = new FPakFile(LowerLevel, *FullPathOnDisk, false);
+
+#if !UE_BUILD_SHIPPING
+		if (!Pak->IsValid())
+		{
+			// same sandbox issue as when mounting (see MountPakFile)
+			FString SandboxedPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*FullPathOnDisk);
+			Pak = new FPakFile(LowerLevel, *SandboxedPath, false);
+		}
+#endif
+		return Pak->IsValid() ? Pak : nullptr;
+	}
+
+	void OpenPakFile(const TSharedRef<FPakFileRecord>& PakFile, FOpenedPak& Out) const
+	{
+		Out.FullPathOnDisk = (PakFile->bIsEmbedded ? EmbeddedFolder : CacheFolder) / PakFile->Entry.FileName;
+		TRefCountPtr<FPakFile> Pak = OpenUnmountedPakFile(Out.FullPathOnDisk);
+		if (!Pak)
+		{
+			// mounting it will fail and report it
+			return;
+		}
+
+		// lazy verification: the pak was checked before mounting it, check a few of the files within it too.
+		if (PakFilesToSample.Contains(PakFile))
+		{
+			if (CheckPakFileSamples(*Pak, Out.FullPathOnDisk, PakFile->Entry.FileSize, NumVerificationSamples))
+			{
+				Out.VerifyStatus = EVerifyStatus::Sampled;
+			}
+			else
+			{
+				// don't give up on the file without a full hash, in case something else tripped the sampling
+				UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Sampled verification of %s from chunk %d failed, checking the whole file."), *Out.FullPathOnDisk, ChunkId);
+				if (CheckFileSha1Hash(Out.FullPathOnDisk, PakFile->Entry.FileVersion))
+				{
+					Out.VerifyStatus = EVerifyStatus::Verified;
+				}
+				else
+				{
+					UE_LOG(LogChunkDownloaderCustom, Error, TEXT("%s from chunk %d failed verification."), *Out.FullPathOnDisk, ChunkId);
+					Out.bFailedVerification = true;
+					return;
+				}
+			}
+		}
+
+		// index the content while we're on a worker, so queries don't have to walk the pak
+		BuildContentIndex(*Pak, Out.Content);
+	}
+
+	void LoadRegistryFragment()
+	{
+		const FString FullPathOnDisk = (RegistryFragmentFile->bIsEmbedded ? EmbeddedFolder : CacheFolder) / RegistryFragmentFile->Entry.FileName;
+
+		// it can't be sampled like the paks, but it's small enough to hash whole
+		if (bVerifyRegistryFragment)
+		{
+			if (!CheckFileSha1Hash(FullPathOnDisk, RegistryFragmentFile->Entry.FileVersion))
+			{
+				UE_LOG(LogChunkDownloaderCustom, Error, TEXT("%s from chunk %d failed verification."), *FullPathOnDisk, ChunkId);
+				FailedPakFiles.Add(RegistryFragmentFile.ToSharedRef());
+				return;
+			}
+			RegistryFragmentVerifyStatus = EVerifyStatus::Verified;
+		}
+
+		RegistryFragment = MakeShared<FAssetRegistryState>();
+		if (!FAssetRegistryState::LoadFromDisk(*FullPathOnDisk, FAssetRegistryLoadOptions(), *RegistryFragment))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Unable to load asset registry fragment '%s' for chunk %d, scans will read its files."), *FullPathOnDisk, ChunkId);
+			RegistryFragment.Reset();
+		}
+	}
+
+public: // inputs
+
+	uint32 TaskId = 0;
+	TQueue<uint32, EQueueMode::Mpsc>* CompletionQueue = nullptr;
+	int32 ChunkId;
+	bool bIsUnmountTask;
+	bool bPreScanAssets;
+
+	// part of a batch (game thread only), mount points get registered for the whole batch at once
+	TSharedPtr<FMountBatch> Batch;
+	bool bDeferRegistration = false;
+	int32 NumVerificationSamples = 0;
+
+	// folders to save pak files into on disk
+	FString CacheFolder;
+	FString EmbeddedFolder;
+
+	// mount/unmount these IN ORDER
+	TArray<TSharedRef<FPakFileRecord>> PakFiles;
+
+	// pak files that haven't been verified yet (lazy mount verification)
+	TArray<TSharedRef<FPakFileRecord>> PakFilesToSample;
+
+	// the chunk's serialized asset registry, if it has one (built per chunk by BuildPakFiles.js), and whether to hash it first (lazy mount verification)
+	TSharedPtr<FPakFileRecord> RegistryFragmentFile;
+	bool bVerifyRegistryFragment = false;
+
+	// callbacks
+	TArray<FCallback> PostMountCallbacks;
+
+public: // results
+
+	// files which were successfully mounted/unmounted
+	TMap<TSharedRef<FPakFileRecord>, FPakMountWorkResult> ProcessedPakFiles;
+
+	// files which failed lazy verification (not mounted)
+	TArray<TSharedRef<FPakFileRecord>> FailedPakFiles;
+
+	// the state loaded from RegistryFragmentFile (appending it to the asset registry has to be done on the game thread)
+	TSharedPtr<FAssetRegistryState> RegistryFragment;
+	EVerifyStatus RegistryFragmentVerifyStatus = EVerifyStatus::Unverified;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+FChunkDownloaderCustom::FChunkDownloaderCustom()
+	: GameThreadWork(MakeShared<FGameThreadWork>())
+	, DownloadResults(MakeShared<FDownloadResultQueue, ESPMode::ThreadSafe>())
+{
+}
+
+FChunkDownloaderCustom::~FChunkDownloaderCustom()
+{
+	// this will be true unless we forgot to have Finalize called.
+	check(PakFiles.Num() <= 0);
+}
+
+void FChunkDownloaderCustom::Initialize(const FString& InPlatformName, int32 TargetDownloadsInFlightIn)
+{
+	check(PakFiles.Num() == 0); // this means we didn't call Finalize
+	check(!InPlatformName.IsEmpty());
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Initializing with platform = \"%s\" and %d threads"), *InPlatformName, TargetDownloadsInFlightIn);
+    
+    FPlatformMisc::AddAdditionalRootDirectory(FPaths::Combine(*FPaths::ProjectPersistentDownloadDir(), TEXT("pakcache")));
+
+	// save platform name
+	PlatformName = InPlatformName;
+
+	// save target concurrency
+	TargetDownloadsInFlight = TargetDownloadsInFlightIn;
+	check(TargetDownloadsInFlight >= 1);
+
+	// optional lazy verification of paks at mount time
+	GConfig->GetBool(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("bLazyMountVerification"), bLazyMountVerification, GGameIni);
+	GConfig->GetInt(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("LazyVerificationSamples"), NumLazyVerificationSamples, GGameIni);
+
+	// optional time-sliced asset registry scans after mounting
+	GConfig->GetBool(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("bAsyncAssetScan"), bAsyncAssetScan, GGameIni);
+	GConfig->GetInt(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("AssetScanSliceSize"), AssetScanSliceSize, GGameIni);
+	AssetScanSliceSize = FMath::Max(AssetScanSliceSize, 1);
+
+	// per-frame time budget for completions, callbacks and manifest saves on the game thread
+	GConfig->GetDouble(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("GameThreadFrameBudgetMs"), GameThreadWork->FrameBudgetMs, GGameIni);
+
+	// optional page cache prewarming after mounting
+	GConfig->GetBool(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("bPrewarmMountedChunks"), bPrewarmMountedChunks, GGameIni);
+	GConfig->GetInt64(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("PrewarmBudgetBytes"), PrewarmBudgetBytes, GGameIni);
+
+	// optional background downloads of the chunks most likely to be requested next
+	GConfig->GetBool(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("bPrefetchPredictor"), bPrefetchPredictor, GGameIni);
+	GConfig->GetFloat(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("PrefetchMinProbability"), PrefetchMinProbability, GGameIni);
+	GConfig->GetInt(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("PrefetchMaxChunks"), PrefetchMaxChunks, GGameIni);
+	GConfig->GetInt64(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("PrefetchBudgetBytes"), PrefetchBudgetBytes, GGameIni);
+
+	// how fast the bandwidth estimate used to predict missed deadlines follows new samples (0..1)
+	GConfig->GetFloat(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("DownloadBandwidthSmoothing"), DownloadBandwidthSmoothing, GGameIni);
+	DownloadBandwidthSmoothing = FMath::Clamp(DownloadBandwidthSmoothing, 0.01f, 1.0f);
+
+	// weighted sharing of the download slots, e.g. +DownloadClassWeights=Patch:4 (Default is the class of requests that don't name one)
+	TArray<FString> DownloadClassWeightStrings;
+	GConfig->GetArray(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("DownloadClassWeights"), DownloadClassWeightStrings, GGameIni);
+	DownloadClassWeights.Empty();
+	for (const FString& ClassWeight : DownloadClassWeightStrings)
+	{
+		FString ClassName, Weight;
+		if (!ClassWeight.Split(TEXT(":"), &ClassName, &Weight))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring download class weight '%s' (expected Class:Weight)."), *ClassWeight);
+			continue;
+		}
+		DownloadClassWeights.Add(ClassName == DEFAULT_DOWNLOAD_CLASS ? NAME_None : FName(*ClassName), FMath::Max(FCString::Atof(*Weight), 0.01f));
+	}
+
+	// the background install and speculative prefetches yield the download slots to everything else unless configured otherwise
+	DownloadClassWeights.FindOrAdd(BACKGROUND_INSTALL_DOWNLOAD_CLASS, 0.1f);
+	DownloadClassWeights.FindOrAdd(PREFETCH_DOWNLOAD_CLASS, 0.1f);
+
+	// optional download of the whole catalog in the background, within disk quotas
+	bool bBackgroundInstall = false;
+	GConfig->GetBool(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("bBackgroundInstall"), bBackgroundInstall, GGameIni);
+	GConfig->GetInt64(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("BackgroundInstallMinFreeBytes"), BackgroundInstallMinFreeBytes, GGameIni);
+	GConfig->GetInt64(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("BackgroundInstallMaxCacheBytes"), BackgroundInstallMaxCacheBytes, GGameIni);
+
+	// optional background verification of the cache
+	bool bCacheScrubber = false;
+	int64 CacheScrubberBytesPerSecond = 1024 * 1024;
+	GConfig->GetBool(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("bCacheScrubber"), bCacheScrubber, GGameIni);
+	GConfig->GetInt64(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("CacheScrubberBytesPerSecond"), CacheScrubberBytesPerSecond, GGameIni);
+
+	// figure out our base dirs
+	CacheFolder = FPaths::ProjectPersistentDownloadDir() / TEXT("PakCache/");
+	EmbeddedFolder = FPaths::ProjectContentDir() / TEXT("EmbeddedPaks/");
+
+	// make sure the cache folder exists
+	IFileManager& FileManager = IFileManager::Get();
+	if (!FileManager.MakeDirectory(*CacheFolder, true))
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to create cache folder at '%s'"), *CacheFolder);
+	}
+
+	// see what's in the embedded chunks folder
+	EmbeddedPaks.Empty();
+	for (const FPakManifestEntry& Entry : ParseManifest(EmbeddedFolder / EMBEDDED_MANIFEST))
+	{
+		// just index these
+		EmbeddedPaks.Add(Entry.FileName, Entry);
+	}
+
+	// enumerate the caches dir and delete anything not in the local manifest
+	TArray<FString> StrayFiles;
+	FileManager.FindFiles(StrayFiles, *CacheFolder, TEXT("*.pak"));
+
+	// load the LocalManifest to see what we've got on disk
+	TArray<FPakManifestEntry> LocalManifest = ParseManifest(CacheFolder / LOCAL_MANIFEST);
+
+	// load the files we already verified (so we don't need to hash them again)
+	TMap<FString, FString> VerifiedManifestProps;
+	TMap<FString, FVerifiedFileEntry> VerifiedFiles = ParseVerifiedManifest(CacheFolder / VERIFIED_MANIFEST, &VerifiedManifestProps);
+	ScrubCursor = VerifiedManifestProps.FindRef(SCRUB_CURSOR_KEY);
+	int32 NumVerifiedFiles = 0;
+	if (LocalManifest.Num() > 0)
+	{
+		// make entries in PakFileInfo for each thing in the local cache (will fill in when BuildManifest is loaded)
+		for (const FPakManifestEntry& Entry : LocalManifest)
+		{
+			// make a new file info
+			TSharedRef<FPakFileRecord> FileInfo = MakeShared<FPakFileRecord>();
+
+			// copy over entry fields (more will be filled in by BuildManifest)
+			FileInfo->Entry = Entry;
+
+			// see if there's a partial or cached file
+			FString LocalPath = CacheFolder / Entry.FileName;
+			int64 SizeOnDiskInt = FileManager.FileSize(*LocalPath);
+			if (SizeOnDiskInt > 0)
+			{
+				FileInfo->SizeOnDisk = (uint64)SizeOnDiskInt;
+				if (FileInfo->SizeOnDisk > Entry.FileSize)
+				{
+					// abort adding this file info (it's too big, we'll delete it)
+					UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Found '%s' on disk with size larger than LocalManifest indicates"), *LocalPath);
+					bNeedsManifestSave = true;
+					continue;
+				}
+
+				// see if this is a fullly cached file
+				if (FileInfo->SizeOnDisk == Entry.FileSize)
+				{
+					// consider size match to be fully downloaded
+					FileInfo->bIsCached = true;
+
+					// but only trust its contents if we verified this exact file before, otherwise it will be verified before mounting
+					const FVerifiedFileEntry* VerifiedFile = VerifiedFiles.Find(Entry.FileName);
+					if (VerifiedFile != nullptr && VerifiedFile->FileSize == Entry.FileSize && VerifiedFile->FileVersion == Entry.FileVersion)
+					{
+						FileInfo->VerifyStatus = EVerifyStatus::Verified;
+						FileInfo->VerifiedTimeStamp = VerifiedFile->TimeStamp;
+						FileInfo->VerifiedAt = VerifiedFile->VerifiedAt;
+					}
+
+					// only files we can verify have a verification record (see SaveVerifiedManifest)
+					if (!CanVerifyPakFile(*FileInfo))
+					{
+						// nothing more to check than the size
+					}
+					else if (IsPakFileVerified(*FileInfo))
+					{
+						++NumVerifiedFiles;
+					}
+					else
+					{
+						UE_LOG(LogChunkDownloaderCustom, Log, TEXT("'%s' matches the expected size but hasn't been verified (will verify before mounting)"), *LocalPath);
+						FileInfo->VerifyStatus = EVerifyStatus::Unverified;
+					}
+				}
+
+				// add the info
+				PakFiles.Add(Entry.FileName, FileInfo);
+			}
+			else
+			{
+				// remove this from the local manifest and resave (may be that we crashed before the file download successfully started)
+				UE_LOG(LogChunkDownloaderCustom, Log, TEXT("'%s' appears in LocalManifest but is not on disk (not necessarily a problem)"), *LocalPath);
+				bNeedsManifestSave = true;
+			}
+
+			// remove from StrayFiles
+			StrayFiles.RemoveSingle(Entry.FileName);
+		}
+	}
+
+	// delete any stray files that weren't in the local manifest
+	for (FString Orphan : StrayFiles)
+	{
+		bNeedsManifestSave = true;
+		FString FullPathOnDisk = CacheFolder / Orphan;
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Deleting orphaned file '%s'"), *FullPathOnDisk);
+		if (!ensure(FileManager.Delete(*FullPathOnDisk)))
+		{
+			// log an error (best we can do)
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to delete '%s'"), *FullPathOnDisk);
+		}
+	}
+
+	// drop any stale verification records
+	if (NumVerifiedFiles != VerifiedFiles.Num())
+	{
+		bNeedsVerifiedManifestSave = true;
+	}
+
+	// resave the local manifest
+	SaveLocalManifest(false);
+
+	// what we learned about chunk access sequences in previous sessions
+	LoadChunkTransitions();
+
+	if (bCacheScrubber)
+	{
+		StartCacheScrubber(CacheScrubberBytesPerSecond);
+	}
+
+	// resume a background install started in a previous session
+	if (bBackgroundInstall || FileManager.FileExists(*(CacheFolder / BACKGROUND_INSTALL_MARKER)))
+	{
+		StartBackgroundInstall();
+	}
+}
+
+bool FChunkDownloaderCustom::LoadCachedBuild(const FString& DeploymentName)
+{
+	// try to re-populate ContentBuildId and the cached manifest
+	TMap<FString, FString> CachedManifestProps;
+	TArray<FPakManifestEntry> CachedManifest = ParseManifest(CacheFolder / CACHED_BUILD_MANIFEST, &CachedManifestProps);
+	const FString* BuildId = CachedManifestProps.Find(BUILD_ID_KEY);
+	if (BuildId == nullptr || BuildId->IsEmpty())
+	{
+		return false;
+	}
+
+	SetContentBuildId(DeploymentName, *BuildId);
+	LoadManifest(CachedManifest);
+	LoadContentListing();
+	return true;
+}
+
+void FChunkDownloaderCustom::SetContentBuildId(const FString& DeploymentName, const FString& NewContentBuildId)
+{
+	// save the content build id
+	ContentBuildId = NewContentBuildId;
+	LastDeploymentName = DeploymentName;
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Deployment = %s, ContentBuildId = %s"), *DeploymentName, *ContentBuildId);
+
+	// read CDN urls from deployment configs
+	TArray<FString> CdnBaseUrls;
+	FString ConfigSectionName = FString::Printf(TEXT("/Script/Plugins.ChunkDownloaderCustom %s"), *DeploymentName);
+	GConfig->GetArray(*ConfigSectionName, TEXT("CdnBaseUrls"), CdnBaseUrls, GGameIni);
+	if (CdnBaseUrls.Num() <= 0)
+	{
+		// fall back to generic config
+		GConfig->GetArray(TEXT("/Script/Plugins.ChunkDownloaderCustom"), TEXT("CdnBaseUrls"), CdnBaseUrls, GGameIni);
+		if (CdnBaseUrls.Num() <= 0)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("No CDN base URLs configured in [%s]."), *ConfigSectionName);
+			
+			// fall back to Epic's original ChunkDownloader plugin
+
+			// read CDN urls from deployment configs
+			FString EpicConfigSectionName = FString::Printf(TEXT("/Script/Plugins.ChunkDownloader %s"), *DeploymentName);
+			GConfig->GetArray(*EpicConfigSectionName, TEXT("CdnBaseUrls"), CdnBaseUrls, GGameIni);
+			if (CdnBaseUrls.Num() <= 0)
+			{
+				// fall back to generic config
+				GConfig->GetArray(TEXT("/Script/Plugins.ChunkDownloader"), TEXT("CdnBaseUrls"), CdnBaseUrls, GGameIni);
+				if (CdnBaseUrls.Num() <= 0)
+				{
+					UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("No CDN base URLs configured in [%s]. Chunk downloading will only be able to use embedded cache."), *EpicConfigSectionName);
+				}
+			}
+		}
+	}
+
+	// combine CdnBaseUrls with ContentBuildId
+	BuildBaseUrls.Empty();
+	for (int32 i=0,n=CdnBaseUrls.Num();i<n;++i)
+	{
+		const FString& BaseUrl = CdnBaseUrls[i];
+		check(!BaseUrl.IsEmpty());
+		FString BuildUrl = BaseUrl / ContentBuildId;
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("ContentBaseUrl[%d] = %s"), i, *BuildUrl);
+		BuildBaseUrls.Add(BuildUrl);
+	}
+}
+
+void FChunkDownloaderCustom::UpdateBuild(const FString& DeploymentName, const FString& ContentBuildIdIn, const FCallback& Callback, bool bPreloadCachedBuild)
+{
+	check(!ContentBuildIdIn.IsEmpty());
+
+	// if the build ID hasn't changed, there's no work to do
+	if (ContentBuildIdIn == ContentBuildId && LastDeploymentName == DeploymentName)
+	{
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	// Preload cached data if needed.
+	if (bPreloadCachedBuild)
+	{
+		LoadCachedBuild(DeploymentName);
+	}
+
+	SetContentBuildId(DeploymentName, ContentBuildIdIn);
+
+	// no overlapped UpdateBuild calls allowed, and Callback is required
+	check(!UpdateBuildCallback);
+	check(Callback);
+	UpdateBuildCallback = Callback;
+
+	// start the load/download process
+	TryLoadBuildManifest(0);
+}
+
+void FChunkDownloaderCustom::Finalize()
+{
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Finalizing."));
+
+	// stop verifying the cache
+	StopCacheScrubber();
+
+	// stop installing in the background (without forgetting about it, the next session resumes it)
+	if (BackgroundInstallTicker.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(BackgroundInstallTicker);
+		BackgroundInstallTicker.Reset();
+	}
+	BackgroundInstallChunk = INDEX_NONE;
+	BackgroundInstallPauseReason = nullptr;
+	BackgroundInstallSkipped.Empty();
+
+	// stop scanning assets
+	CancelAssetScans();
+
+	// wait for all mounts to finish
+	WaitForMounts();
+
+	// update the mount tasks (queues up callbacks)
+	ensure(UpdateMountTasks(0.0f) == false);
+
+	// stop measuring bandwidth
+	if (DownloadScheduleTicker.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(DownloadScheduleTicker);
+		DownloadScheduleTicker.Reset();
+	}
+
+	// results of downloads in flight are ignored from here on (they're all canceled below)
+	if (DownloadTicker.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(DownloadTicker);
+		DownloadTicker.Reset();
+	}
+
+	// cancel all downloads
+	for (const auto& It : PakFiles)
+	{
+		const TSharedRef<FPakFileRecord>& File = It.Value;
+		if (File->Download.IsValid())
+		{
+			CancelDownload(File, false);
+		}
+	}
+
+	// unmount all mounted chunks (best effort)
+	for (const auto& It : Chunks)
+	{
+		const TSharedRef<FChunk>& Chunk = It.Value;
+		if (Chunk->bIsMounted)
+		{
+			// unmount the paks (in reverse order)
+			for (int32 i=Chunk->PakFiles.Num()-1;i >= 0; --i)
+			{
+				const TSharedRef<FPakFileRecord>& PakFile = Chunk->PakFiles[i];
+				UnmountPakFile(PakFile);
+			}
+
+			// clear the flag
+			Chunk->bIsMounted = false;
+		}
+	}
+
+	// write the manifest now, mount completions and canceled downloads above may have changed it and the pak files are about to go away
+	SaveLocalManifest(true);
+
+	// clear pak files and chunks
+	LastLocalManifest.Empty();
+	PakFiles.Empty();
+	Chunks.Empty();
+
+	// cancel any pending manifest request
+	if (ManifestRequest.IsValid())
+	{
+		ManifestRequest->CancelRequest();
+		ManifestRequest.Reset();
+	}
+	if (ContentListingRequest.IsValid())
+	{
+		ContentListingRequest->CancelRequest();
+		ContentListingRequest.Reset();
+	}
+	PackageChunks.Empty();
+
+	// write the access history now if its save was deferred
+	bTransitionSaveDeferred = false;
+	WriteChunkTransitions(false);
+	PrefetchedChunks.Empty();
+
+	// nothing left to acquire packages from
+	for (const auto& It : PackageAcquisitions)
+	{
+		for (const FCallback& Callback : It.Value->Callbacks)
+		{
+			ExecuteNextTick(Callback, false);
+		}
+	}
+	PackageAcquisitions.Empty();
+
+	// any loading mode is de-facto complete
+	if (PostLoadCallbacks.Num() > 0)
+	{
+		TArray<FCallback> Callbacks = MoveTemp(PostLoadCallbacks);
+		PostLoadCallbacks.Empty();
+		for (const auto& Callback : Callbacks)
+		{
+			ExecuteNextTick(Callback, false);
+		}
+	}
+
+	// update is also de-facto complete
+	if (UpdateBuildCallback)
+	{
+		FCallback Callback = MoveTemp(UpdateBuildCallback);
+		ExecuteNextTick(Callback, false);
+	}
+
+	// clear out the content build id
+	ContentBuildId.Empty();
+}
+
+void FChunkDownloaderCustom::SaveLocalManifest(bool bForce)
+{
+	if (bForce)
+	{
+		bManifestSaveDeferred = false;
+		WriteLocalManifest(true);
+		return;
+	}
+
+	// a burst of requests in one frame only needs the last write
+	if (!bManifestSaveDeferred && (bNeedsManifestSave || bNeedsVerifiedManifestSave))
+	{
+		bManifestSaveDeferred = true;
+		TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+		DeferWork(TEXT("Manifest save"), [WeakThisPtr]() {
+			TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+			if (SharedThis.IsValid() && SharedThis->bManifestSaveDeferred)
+			{
+				SharedThis->bManifestSaveDeferred = false;
+				SharedThis->WriteLocalManifest(false);
+			}
+		});
+	}
+}
+
+void FChunkDownloaderCustom::WriteLocalManifest(bool bForce)
+{
+	if (bForce || bNeedsManifestSave)
+	{
+		// build the whole file into an FString (wish we could stream it out)
+		int32 NumEntries = 0;
+		for (const auto& It : PakFiles)
+		{
+			if (!It.Value->bIsEmbedded)
+			{
+				if (It.Value->SizeOnDisk > 0 || It.Value->Download.IsValid())
+				{
+					++NumEntries;
+				}
+			}
+		}
+
+		// Clear cached local manifest data
+		LastLocalManifest.Empty(NumEntries);
+
+		FString PakFileText = FString::Printf(TEXT("$NUM_ENTRIES = %d\n"), NumEntries);
+		for (const auto& It : PakFiles)
+		{
+			if (!It.Value->bIsEmbedded)
+			{
+				if (It.Value->SizeOnDisk > 0 || It.Value->Download.IsValid())
+				{
+					// local manifest
+					const FPakManifestEntry& PakFile = It.Value->Entry;
+					PakFileText += FString::Printf(TEXT("%s\t%llu\t%s\t-1\t/\n"), *PakFile.FileName, PakFile.FileSize, *PakFile.FileVersion);
+
+					// cached local manifest data
+					LastLocalManifest.Add(PakFile);
+				}
+			}
+		}
+
+		// write the file
+		FString ManifestPath = CacheFolder / LOCAL_MANIFEST;
+		if (WriteStringAsUtf8TextFile(PakFileText, ManifestPath))
+		{
+			// mark that we have saved
+			bNeedsManifestSave = false;
+		}
+	}
+
+	// keep the verified manifest in sync with the local one
+	SaveVerifiedManifest(false);
+}
+
+void FChunkDownloaderCustom::SaveVerifiedManifest(bool bForce)
+{
+	if (bForce || bNeedsVerifiedManifestSave)
+	{
+		int32 NumEntries = 0;
+		for (const auto& It : PakFiles)
+		{
+			if (It.Value->VerifyStatus == EVerifyStatus::Verified && !It.Value->bIsEmbedded)
+			{
+				++NumEntries;
+			}
+		}
+
+		FString VerifiedFileText = FString::Printf(TEXT("$NUM_ENTRIES = %d\n"), NumEntries);
+		if (!ScrubCursor.IsEmpty())
+		{
+			VerifiedFileText += FString::Printf(TEXT("$%s = %s\n"), *SCRUB_CURSOR_KEY, *ScrubCursor);
+		}
+		for (const auto& It : PakFiles)
+		{
+			const FPakFileRecord& PakFile = *It.Value;
+			if (PakFile.VerifyStatus == EVerifyStatus::Verified && !PakFile.bIsEmbedded)
+			{
+				VerifiedFileText += FString::Printf(TEXT("%s\t%llu\t%s\t%lld\t%lld\n"), *PakFile.Entry.FileName, PakFile.Entry.FileSize, *PakFile.Entry.FileVersion,
+					PakFile.VerifiedTimeStamp.GetTicks(), PakFile.VerifiedAt.GetTicks());
+			}
+		}
+
+		// write the file
+		FString ManifestPath = CacheFolder / VERIFIED_MANIFEST;
+		if (WriteStringAsUtf8TextFile(VerifiedFileText, ManifestPath))
+		{
+			// mark that we have saved
+			bNeedsVerifiedManifestSave = false;
+		}
+	}
+}
+
+void FChunkDownloaderCustom::WaitForMounts()
+{
+	bool bWaiting = false;
+
+	// completing a task may start another one (e.g. to repair a pak file)
+	while (PendingMountTasks.Num() > 0)
+	{
+		if (!bWaiting)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Waiting for chunk mounts to complete..."));
+			bWaiting = true;
+		}
+
+		TArray<uint32> TaskIds;
+		PendingMountTasks.GenerateKeyArray(TaskIds);
+		for (uint32 TaskId : TaskIds)
+		{
+			// may have been completed along with the rest of its batch
+			FMountTask** MountTaskPtr = PendingMountTasks.Find(TaskId);
+			if (MountTaskPtr == nullptr)
+			{
+				continue;
+			}
+
+			// wait for the async task to end
+			FMountTask* MountTask = *MountTaskPtr;
+			MountTask->EnsureCompletion(true);
+
+			// complete the task on the main thread
+			FinishMountTask(MountTask);
+		}
+	}
+
+	if (bWaiting)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("...chunk mounts finished."));
+	}
+}
+
+void FChunkDownloaderCustom::CancelDownload(const TSharedRef<FPakFileRecord>& PakFile, bool bResult)
+{
+	if (PakFile->Download.IsValid())
+	{
+		// cancel the download itself
+		PakFile->Download->Cancel(bResult);
+		check(!PakFile->Download.IsValid());
+	}
+}
+
+void FChunkDownloaderCustom::UnmountPakFile(const TSharedRef<FPakFileRecord>& PakFile)
+{
+	// This is independent from the async mount/unmount task because it's used mainly when finalizing the module.
+
+	// if it's already unmounted, don't do anything
+	if (PakFile->bIsMounted)
+	{
+		// unmount
+		if (ensure(FCoreDelegates::OnUnmountPak.IsBound()))
+		{
+			FString FullPathOnDisk	= (PakFile->bIsEmbedded ? EmbeddedFolder : CacheFolder) / PakFile->Entry.FileName;
+			if (ensure(FCoreDelegates::OnUnmountPak.Execute(FullPathOnDisk)))
+			{
+				FPakFile* Pak = PakFile->Pak.GetReference();
+
+				// pak file was registered to the file system when mounted
+				if (PakFile->IsRegistered == ERegistryStatus::Registered)
+				{
+					FString MountPoint = Pak->GetMountPoint();
+					FPackageName::UnRegisterMountPoint(GetRootDir(MountPoint), MountPoint);
+				}
+
+				// clear the mounted flag
+				PakFile->IsRegistered = ERegistryStatus::Untracked;
+				PakFile->bIsMounted = false;
+				PakFile->Pak.SafeRelease();
+				PakFile->Content.Reset();
+			}
+			else
+			{
+				UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to unmount %s"), *FullPathOnDisk);
+			}
+		}
+		else
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to unmount %s because no OnUnmountPak is bound"), *PakFile->Entry.FileName);
+		}
+	}
+}
+
+EChunkStatus FChunkDownloaderCustom::GetChunkStatus(int32 ChunkId) const
+{
+	// do we know about this chunk at all?
+	const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+	if (ChunkPtr == nullptr)
+	{
+		return EChunkStatus::Unknown;
+	}
+	const FChunk& Chunk = **ChunkPtr;
+
+	RefreshChunkStatus(Chunk);
+	return Chunk.CachedStatus;
+}
+
+void FChunkDownloaderCustom::GetChunkStatuses(const TArray<int32>& ChunkIds, TArray<FChunkStatusInfo>& OutStatuses) const
+{
+	OutStatuses.Reset(ChunkIds.Num());
+	for (int32 ChunkId : ChunkIds)
+	{
+		FChunkStatusInfo& Info = OutStatuses.AddDefaulted_GetRef();
+		Info.ChunkId = ChunkId;
+
+		const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+		if (ChunkPtr != nullptr)
+		{
+			const FChunk& Chunk = **ChunkPtr;
+			RefreshChunkStatus(Chunk);
+			Info.Status = Chunk.CachedStatus;
+			Info.BytesCached = Chunk.CachedBytesCached;
+			Info.BytesTotal = Chunk.CachedBytesTotal;
+		}
+	}
+}
+
+void FChunkDownloaderCustom::GetAllChunkStatuses(TArray<FChunkStatusInfo>& OutStatuses) const
+{
+	OutStatuses.Reset(Chunks.Num());
+	for (const auto& It : Chunks)
+	{
+		const FChunk& Chunk = *It.Value;
+		RefreshChunkStatus(Chunk);
+
+		FChunkStatusInfo& Info = OutStatuses.AddDefaulted_GetRef();
+		Info.ChunkId = Chunk.ChunkId;
+		Info.Status = Chunk.CachedStatus;
+		Info.BytesCached = Chunk.CachedBytesCached;
+		Info.BytesTotal = Chunk.CachedBytesTotal;
+	}
+}
+
+void FChunkDownloaderCustom::InvalidateChunkStatus(const FPakFileRecord& PakFile)
+{
+	const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(PakFile.Entry.ChunkId);
+	if (ChunkPtr != nullptr)
+	{
+		(*ChunkPtr)->bStatusDirty = true;
+	}
+}
+
+void FChunkDownloaderCustom::RefreshChunkStatus(const FChunk& Chunk) const
+{
+	if (!Chunk.bStatusDirty)
+	{
+		return;
+	}
+	Chunk.bStatusDirty = false;
+
+	// count the number of paks in flight vs local
+	int32 NumPaks = Chunk.PakFiles.Num(), NumCached = 0, NumDownloading = 0;
+	Chunk.CachedBytesCached = 0;
+	Chunk.CachedBytesTotal = 0;
+	for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+	{
+		Chunk.CachedBytesTotal += PakFile->Entry.FileSize;
+		if (PakFile->bIsCached)
+		{
+			Chunk.CachedBytesCached += PakFile->Entry.FileSize;
+			++NumCached;
+		}
+		else if (PakFile->Download.IsValid())
+		{
+			++NumDownloading;
+		}
+	}
+
+	if (!ensure(NumPaks > 0))
+	{
+		// if it has no pak files, treat it the same as not found (shouldn't happen)
+		Chunk.CachedStatus = EChunkStatus::Unknown;
+	}
+	else if (Chunk.bIsMounted)
+	{
+		// fully mounted
+		Chunk.CachedStatus = EChunkStatus::Mounted;
+	}
+	else if (NumCached >= NumPaks)
+	{
+		// all cached
+		Chunk.CachedStatus = EChunkStatus::Cached;
+	}
+	else if (NumCached + NumDownloading >= NumPaks)
+	{
+		// some downloads still in progress
+		Chunk.CachedStatus = EChunkStatus::Downloading;
+	}
+	else if (NumCached + NumDownloading > 0)
+	{
+		// any progress at all? (might be paused or partially preserved from manifest update)
+		Chunk.CachedStatus = EChunkStatus::Partial;
+	}
+	else
+	{
+		// nothing
+		Chunk.CachedStatus = EChunkStatus::Remote;
+	}
+}
+
+void FChunkDownloaderCustom::GetAllChunkIds(TArray<int32>& OutChunkIds) const
+{
+	Chunks.GetKeys(OutChunkIds);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void FChunkDownloaderCustom::DumpLoadedChunks()
+{
+#if !WITH_EDITOR
+	TSharedRef<FChunkDownloaderCustom> ChunkDownloader = FChunkDownloaderCustom::GetChecked();
+
+	TArray<FChunkStatusInfo> ChunkStatuses;
+	ChunkDownloader->GetAllChunkStatuses(ChunkStatuses);
+
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Dumping loaded chunk status\n--------------------------"));
+	for (const FChunkStatusInfo& Info : ChunkStatuses)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Chunk #%d => %s (%llu/%llu bytes cached)"), Info.ChunkId, ChunkStatusToString(Info.Status), Info.BytesCached, Info.BytesTotal);
+	}
+
+	const FPackageAcquireStats& AcquireStats = ChunkDownloader->GetPackageAcquireStats();
+	const int32 NumMissesDone = AcquireStats.NumMisses - ChunkDownloader->PackageAcquisitions.Num();
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Package acquisitions: %d requests, %d misses (%d joined, %d failed), %.1f ms average miss, %.1f ms worst"),
+		AcquireStats.NumRequests, AcquireStats.NumMisses, AcquireStats.NumJoined, AcquireStats.NumFailed,
+		NumMissesDone > 0 ? AcquireStats.TotalMissSeconds * 1000.0 / NumMissesDone : 0.0, AcquireStats.MaxMissSeconds * 1000.0);
+
+	const FPrefetchStats& PrefetchStats = ChunkDownloader->GetPrefetchStats();
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Prefetches: %d issued, %d hits (%.0f%%), %llu bytes prefetched, %llu used, %llu wasted, %d pending"),
+		PrefetchStats.NumPrefetches, PrefetchStats.NumHits, PrefetchStats.NumPrefetches > 0 ? PrefetchStats.NumHits * 100.0 / PrefetchStats.NumPrefetches : 0.0,
+		PrefetchStats.BytesPrefetched, PrefetchStats.BytesHit, PrefetchStats.BytesWasted, ChunkDownloader->PrefetchedChunks.Num());
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Download bandwidth: %.0f bytes/s (%d requests, %llu bytes remaining)"),
+		ChunkDownloader->GetDownloadBandwidth(), ChunkDownloader->DownloadRequests.Num(), ChunkDownloader->DownloadRequestBytesRemaining);
+
+	TMap<FName, TPair<int32, int32>> ClassRequests; // in flight, queued
+	for (const TSharedRef<FPakFileRecord>& PakFile : ChunkDownloader->DownloadRequests)
+	{
+		TPair<int32, int32>& Requests = ClassRequests.FindOrAdd(PakFile->DownloadClass);
+		++(PakFile->Download.IsValid() ? Requests.Key : Requests.Value);
+	}
+	for (const auto& It : ClassRequests)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Download class %s (weight %.2f): %d in flight, %d queued"),
+			It.Key.IsNone() ? *DEFAULT_DOWNLOAD_CLASS : *It.Key.ToString(), ChunkDownloader->GetDownloadClassWeight(It.Key), It.Value.Key, It.Value.Value);
+	}
+
+	const FBackgroundInstallProgress InstallProgress = ChunkDownloader->GetBackgroundInstallProgress();
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Background install: %s, %d/%d chunks cached (%llu/%llu bytes), %.0f s remaining, %d skipped"),
+		!InstallProgress.bActive ? TEXT("stopped") : InstallProgress.bPaused ? ChunkDownloader->BackgroundInstallPauseReason : TEXT("running"),
+		InstallProgress.ChunksCached, InstallProgress.TotalChunks, InstallProgress.BytesCached, InstallProgress.TotalBytes,
+		InstallProgress.EstimatedTimeRemaining.GetTotalSeconds(), ChunkDownloader->BackgroundInstallSkipped.Num());
+
+	const FGameThreadWorkStats& WorkStats = ChunkDownloader->GetGameThreadWorkStats();
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Game thread work: %d frames, %d over the %.2f ms budget, %d deferred (max %d queued), %.1f ms total, %.2f ms worst frame, %.2f ms worst item (%s)"),
+		WorkStats.NumFrames, WorkStats.NumFramesOverBudget, ChunkDownloader->GameThreadWork->FrameBudgetMs, WorkStats.NumFramesDeferred, WorkStats.MaxQueuedItems,
+		WorkStats.TotalMs, WorkStats.MaxFrameMs, WorkStats.MaxItemMs, WorkStats.MaxItemName);
+#endif
+}
+
+const TCHAR* FChunkDownloaderCustom::ChunkStatusToString(EChunkStatus Status)
+{
+	switch (Status)
+	{
+	case EChunkStatus::Mounted: return TEXT("Mounted");
+	case EChunkStatus::Cached: return TEXT("Cached");
+	case EChunkStatus::Downloading: return TEXT("Downloading");
+	case EChunkStatus::Partial: return TEXT("Partial");
+	case EChunkStatus::Remote: return TEXT("Remote");
+	case EChunkStatus::Unknown: return TEXT("Unknown");
+	default: return TEXT("Invalid");
+	}
+}
+
+bool FChunkDownloaderCustom::WriteStringAsUtf8TextFile(const FString& FileText, const FString& FilePath)
+{
+	// convert to UTF8
+	FTCHARToUTF8 PakFileUtf8(*FileText);
+
+	// open the file for writing
+	bool bSuccess = false;
+	IFileHandle* ManifestFile = IPlatformFile::GetPlatformPhysical().OpenWrite(*FilePath);
+	if (ManifestFile != nullptr)
+	{
+		// write to the file
+		if (ManifestFile->Write(reinterpret_cast<const uint8*>(PakFileUtf8.Get()), PakFileUtf8.Length()))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Wrote to %s"), *FilePath);
+			bSuccess = true;
+		}
+		else
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Write error writing to %s"), *FilePath);
+		}
+
+		// close the file
+		delete ManifestFile;
+	}
+	else
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable open %s for writing."), *FilePath);
+	}
+	return bSuccess;
+}
+
+bool FChunkDownloaderCustom::CheckFileSha1Hash(const FString& FullPathOnDisk, const FString& Sha1HashStr)
+{
+	IFileHandle* FilePtr = IPlatformFile::GetPlatformPhysical().OpenRead(*FullPathOnDisk);
+	if (FilePtr == nullptr)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to open %s for hash verify."), *FullPathOnDisk);
+		return false;
+	}
+
+	// create a SHA1 reader
+	FSHA1 HashContext;
+	bool bReadSuccess = HashFileRange(*FilePtr, FilePtr->Size(), HashContext, FullPathOnDisk);
+
+	// done with the file
+	delete FilePtr;
+	if (!bReadSuccess)
+	{
+		return false;
+	}
+
+	// close up shop
+	return Sha1HashStr == FinalizeSha1HashString(HashContext);
+}
+
+bool FChunkDownloaderCustom::HashFileRange(IFileHandle& File, int64 Size, FSHA1& HashContext, const FString& FullPathOnDisk)
+{
+	// read in 64K chunks to prevent raising the memory high water mark too much
+	static const int64 FILE_BUFFER_SIZE = 64 * 1024;
+	uint8 Buffer[FILE_BUFFER_SIZE];
+	for (int64 Pointer = 0; Pointer < Size;)
+	{
+		// how many bytes to read in this iteration
+		int64 SizeToRead = Size - Pointer;
+		if (SizeToRead > FILE_BUFFER_SIZE)
+		{
+			SizeToRead = FILE_BUFFER_SIZE;
+		}
+
+		// read dem bytes
+		if (!File.Read(Buffer, SizeToRead))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Read error while validating '%s' at offset %lld."), *FullPathOnDisk, File.Tell());
+			return false;
+		}
+		Pointer += SizeToRead;
+
+		// update the hash
+		HashContext.Update(Buffer, SizeToRead);
+	}
+	return true;
+}
+
+FString FChunkDownloaderCustom::FinalizeSha1HashString(FSHA1& HashContext)
+{
+	HashContext.Final();
+	uint8 FinalHash[FSHA1::DigestSize];
+	HashContext.GetHash(FinalHash);
+
+	// build the hash string we just computed
+	FString LocalHashStr = TEXT("SHA1:");
+	for (int Idx = 0; Idx < 20; Idx++)
+	{
+		LocalHashStr += FString::Printf(TEXT("%02X"), FinalHash[Idx]);
+	}
+	return LocalHashStr;
+}
+
+bool FChunkDownloaderCustom::CheckPakFileSamples(const FPakFile& Pak, const FString& FullPathOnDisk, uint64 ExpectedFileSize, int32 NumSamples)
+{
+	// the footer and index were validated when opening the pak, but they don't tell us whether anything before them is missing
+	if (Pak.TotalSize() != (int64)ExpectedFileSize)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Size mismatch in %s. Expected %llu, got %lld"), *FullPathOnDisk, ExpectedFileSize, Pak.TotalSize());
+		return false;
+	}
+
+	const int32 NumFiles = Pak.GetNumFiles();
+	if (NumFiles <= 0 || NumSamples <= 0)
+	{
+		return true;
+	}
+
+	// pick the files to check (in iteration order)
+	FRandomStream RandomStream(FPlatformTime::Cycles());
+	TArray<int32> SampleIndices;
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		SampleIndices.AddUnique(NumSamples >= NumFiles ? i % NumFiles : RandomStream.RandRange(0, NumFiles - 1));
+	}
+	SampleIndices.Sort();
+
+	IFileHandle* FilePtr = IPlatformFile::GetPlatformPhysical().OpenRead(*FullPathOnDisk);
+	if (FilePtr == nullptr)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to open %s for sampled verify."), *FullPathOnDisk);
+		return false;
+	}
+
+	// large files aren't worth sampling, the background hash will take care of them
+	static const int64 MAX_SAMPLE_SIZE = 1024 * 1024;
+	const int32 PakVersion = Pak.GetInfo().Version;
+	TArray<uint8> HeaderBuffer;
+	TArray<uint8> Buffer;
+	bool bSamplesMatch = true;
+	int32 FileIndex = 0, SampleIndex = 0;
+	for (FPakFile::FFilenameIterator File(Pak); File && SampleIndex < SampleIndices.Num(); ++File, ++FileIndex)
+	{
+		if (FileIndex != SampleIndices[SampleIndex])
+		{
+			continue;
+		}
+		++SampleIndex;
+
+		// the data is stored compressed and encrypted as is, padded to the cipher block size
+		const FPakEntry& Entry = File.Info();
+		const int64 StoredSize = Entry.IsEncrypted() ? Align(Entry.CompressedSize, FAES::AESBlockSize) : Entry.CompressedSize;
+		if (Entry.IsDeleteRecord() || StoredSize > MAX_SAMPLE_SIZE)
+		{
+			continue;
+		}
+
+		// the entry data follows a copy of its header, which is the one with the hash (encoded indexes don't keep it)
+		const int64 HeaderSize = Entry.GetSerializedSize(PakVersion);
+		HeaderBuffer.SetNumUninitialized((int32)HeaderSize);
+		Buffer.SetNumUninitialized((int32)StoredSize);
+		if (!FilePtr->Seek(Entry.Offset) || !FilePtr->Read(HeaderBuffer.GetData(), HeaderSize) || !FilePtr->Read(Buffer.GetData(), StoredSize))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Read error while sampling '%s' at offset %lld."), *FullPathOnDisk, Entry.Offset);
+			bSamplesMatch = false;
+			break;
+		}
+
+		FPakEntry DataEntry;
+		FMemoryReader HeaderReader(HeaderBuffer);
+		DataEntry.Serialize(HeaderReader, PakVersion);
+		if (HeaderReader.IsError() || !DataEntry.IndexDataEquals(Entry))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("%s in %s does NOT match its index entry."), *File.Filename(), *FullPathOnDisk);
+			bSamplesMatch = false;
+			break;
+		}
+
+		uint8 Hash[FSHA1::DigestSize];
+		FSHA1::HashBuffer(Buffer.GetData(), Buffer.Num(), Hash);
+		if (FMemory::Memcmp(Hash, DataEntry.Hash, sizeof(Hash)) != 0)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("%s in %s does NOT match its hash."), *File.Filename(), *FullPathOnDisk);
+			bSamplesMatch = false;
+			break;
+		}
+	}
+
+	// done with the file
+	delete FilePtr;
+	return bSamplesMatch;
+}
+
+TArray<FPakManifestEntry> FChunkDownloaderCustom::ParseManifest(const FString& ManifestPath, TMap<FString, FString>* Properties)
+{
+	int32 ExpectedEntries = -1;
+	TArray<FPakManifestEntry> Entries;
+	IFileHandle* ManifestFile = IPlatformFile::GetPlatformPhysical().OpenRead(*ManifestPath);
+	if (ManifestFile != nullptr)
+	{
+		int64 FileSize = ManifestFile->Size();
+		if (FileSize > 0)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Found manifest at %s"), *ManifestPath);
+
+			// read the whole file into a buffer (expecting UTF-8 so null terminate)
+			char* FileBuffer = new char[FileSize + 8]; // little extra since we're forcing null term in places outside bounds of a field
+			if (ManifestFile->Read((uint8*)FileBuffer, FileSize))
+			{
+				FileBuffer[FileSize] = '\0';
+
+				// make buffers for stuff read from each line
+				char NameBuffer[512] = { 0 };
+				uint64 FinalFileLen = 0;
+				char VersionBuffer[512] = { 0 };
+				int32 ChunkId = -1;
+				char RelativeUrl[2048] = { 0 };
+
+				// line end
+				int LineNum = 0;
+				int NextLineStart = 0;
+				while (NextLineStart < FileSize)
+				{
+					int LineStart = NextLineStart;
+					++LineNum;
+
+					// find the end of the line
+					int LineEnd = LineStart;
+					while (LineEnd < FileSize && FileBuffer[LineEnd] != '\n' && FileBuffer[LineEnd] != '\r')
+					{
+						++LineEnd;
+					}
+
+					// find the end of the line
+					NextLineStart = LineEnd + 1;
+					while (NextLineStart < FileSize && (FileBuffer[NextLineStart] == '\n' || FileBuffer[NextLineStart] == '\r'))
+					{
+						++NextLineStart;
+					}
+
+					// see if this is a property
+					if (FileBuffer[LineStart] == '$')
+					{
+						// parse the line
+						char* NameStart = &FileBuffer[LineStart + 1];
+						char* NameEnd = FCStringAnsi::Strstr(NameStart, " = ");
+						if (NameEnd != nullptr)
+						{
+							char* ValueStart = NameEnd + 3;
+							char* ValueEnd = &FileBuffer[LineEnd];
+							*NameEnd = '\0';
+							*ValueEnd = '\0';
+
+							FString Name = FUTF8ToTCHAR(NameStart, NameEnd - NameStart + 1).Get();
+							FString Value = FUTF8ToTCHAR(ValueStart, ValueEnd - ValueStart + 1).Get();
+							if (Properties != nullptr)
+							{
+								Properties->Add(Name, Value);
+							}
+
+							if (Name == TEXT("NUM_ENTRIES"))
+							{
+								ExpectedEntries = FCString::Atoi(*Value);
+							}
+						}
+						continue;
+					}
+
+					// parse the line
+#if PLATFORM_WINDOWS || PLATFORM_MICROSOFT
+					if (!ensure(sscanf_s(&FileBuffer[LineStart], "%511[^\t]\t%llu\t%511[^\t]\t%d\t%2047[^\r\n]",
+						NameBuffer, (int)sizeof(NameBuffer),
+						&FinalFileLen,
+						VersionBuffer, (int)sizeof(VersionBuffer),
+						&ChunkId,
+						RelativeUrl, (int)sizeof(RelativeUrl)
+					) == 5))
+#else
+					if (!ensure(sscanf(&FileBuffer[LineStart], "%511[^\t]\t%llu\t%511[^\t]\t%d\t%2047[^\r\n]",
+						NameBuffer,
+						&FinalFileLen,
+						VersionBuffer,
+						&ChunkId,
+						RelativeUrl
+					) == 5))
+#endif
+					{
+						UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Manifest parse error at %s:%d"), *ManifestPath, LineNum);
+						continue;
+					}
+
+					// add a new pak file entry
+					FPakManifestEntry Entry;
+					Entry.FileName = UTF8_TO_TCHAR(NameBuffer);
+					Entry.FileSize = FinalFileLen;
+					Entry.FileVersion = UTF8_TO_TCHAR(VersionBuffer);
+					if (ChunkId >= 0)
+					{
+						Entry.ChunkId = ChunkId;
+						Entry.RelativeUrl = UTF8_TO_TCHAR(RelativeUrl);
+					}
+					Entries.Add(Entry);
+				}
+
+				// all done
+				delete[] FileBuffer;
+			}
+			else
+			{
+				UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Read error loading manifest at %s"), *ManifestPath);
+			}
+		}
+		else
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Empty manifest found at %s"), *ManifestPath);
+		}
+
+		// close the file
+		delete ManifestFile;
+	}
+	else
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("No manifest found at %s"), *ManifestPath);
+	}
+
+	if (ExpectedEntries >= 0 && ExpectedEntries != Entries.Num())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Corrupt manifest at %s (expected %d entries, got %d)"), *ManifestPath, ExpectedEntries, Entries.Num());
+		Entries.Empty();
+		if (Properties != nullptr)
+		{
+			Properties->Empty();
+		}
+	}
+
+	return Entries;
+}
+
+TMap<FString, FChunkDownloaderCustom::FVerifiedFileEntry> FChunkDownloaderCustom::ParseVerifiedManifest(const FString& ManifestPath, TMap<FString, FString>* Properties)
+{
+	int32 ExpectedEntries = -1;
+	TMap<FString, FVerifiedFileEntry> Entries;
+
+	FString FileText;
+	if (!FFileHelper::LoadFileToString(FileText, &IPlatformFile::GetPlatformPhysical(), *ManifestPath))
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("No verified manifest found at %s"), *ManifestPath);
+		return Entries;
+	}
+
+	TArray<FString> Lines;
+	FileText.ParseIntoArrayLines(Lines);
+	for (int32 LineNum = 0; LineNum < Lines.Num(); ++LineNum)
+	{
+		const FString& Line = Lines[LineNum];
+
+		// see if this is a property
+		if (Line.StartsWith(TEXT("$")))
+		{
+			FString Name, Value;
+			if (Line.RightChop(1).Split(TEXT(" = "), &Name, &Value))
+			{
+				if (Properties != nullptr)
+				{
+					Properties->Add(Name, Value);
+				}
+
+				if (Name == TEXT("NUM_ENTRIES"))
+				{
+					ExpectedEntries = FCString::Atoi(*Value);
+				}
+			}
+			continue;
+		}
+
+		// name, size, version, time stamp, verification time
+		TArray<FString> Fields;
+		if (!ensure(Line.ParseIntoArray(Fields, TEXT("\t"), false) == 5))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Verified manifest parse error at %s:%d"), *ManifestPath, LineNum + 1);
+			continue;
+		}
+
+		FVerifiedFileEntry& Entry = Entries.Add(Fields[0]);
+		Entry.FileSize = FCString::Strtoui64(*Fields[1], nullptr, 10);
+		Entry.FileVersion = Fields[2];
+		Entry.TimeStamp = FDateTime(FCString::Atoi64(*Fields[3]));
+		Entry.VerifiedAt = FDateTime(FCString::Atoi64(*Fields[4]));
+	}
+
+	if (ExpectedEntries >= 0 && ExpectedEntries != Entries.Num())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Corrupt verified manifest at %s (expected %d entries, got %d)"), *ManifestPath, ExpectedEntries, Entries.Num());
+		Entries.Empty();
+		if (Properties != nullptr)
+		{
+			Properties->Empty();
+		}
+	}
+
+	return Entries;
+}
+
+FString FChunkDownloaderCustom::GetRootDir(const FString& MountPoint)
+{
+	FString RootDir;
+	verify(FPackageName::TryConvertFilenameToLongPackageName(MountPoint, RootDir));
+	return RootDir;
+}
+
+bool FChunkDownloaderCustom::IsMountingToRoot(const FString& MountPoint)
+{
+	FString NormalizedPakMountPoint = FPaths::CreateStandardFilename(MountPoint);
+	bool bIsMountingToRoot = NormalizedPakMountPoint == FPaths::CreateStandardFilename(FPaths::RootDir());
+#if WITH_EDITOR
+	bIsMountingToRoot |= NormalizedPakMountPoint == FPaths::CreateStandardFilename(FPaths::GameFeatureRootPrefix());
+#endif
+	return bIsMountingToRoot;
+}
+
+bool FChunkDownloaderCustom::IsMountPointRegistered(const FString& MountPoint)
+{
+	FString RootDir;
+	return FPackageName::TryConvertFilenameToLongPackageName(MountPoint, RootDir);
+}
+
+FChunkDownloaderCustom::ERegistryStatus FChunkDownloaderCustom::RegisterPakMountPoint(const FString& MountPoint, const FString& FullPathOnDisk, int32 ChunkId)
+{
+	if (IsMountingToRoot(MountPoint) || IsMountPointRegistered(MountPoint))
+	{
+		return ERegistryStatus::Untracked;
+	}
+
+	FString RootDir;
+	if (ParseRootDir(MountPoint, RootDir))
+	{
+		FPackageName::RegisterMountPoint(RootDir, MountPoint);
+		return ERegistryStatus::Registered;
+	}
+
+	UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to register mount point \"%s\" for %s from chunk %d"), *MountPoint, *FullPathOnDisk, ChunkId);
+	return ERegistryStatus::Unregistered;
+}
+
+bool FChunkDownloaderCustom::ParseRootDir(const FString& MountPoint, FString& Result)
+{
+	// NOTE: Mount point should be relative to "/Engine/Binaries/Platform/", as "../../../".
+	// NOTE: The comments below are examples to keep track of how the string parsing should be going along.
+	//		 The "<etc>" bit stands for "the rest of the path" which can be empty and shouldn't affect the outcome of this function.
+
+	FString RightStr = MountPoint;
+	FString LeftStr;
+
+
+	// LeftStr	= ""
+	// RightStr = "../../../<ProjectName>/Content/<etc>/" or "../../../<ProjectName>/Plugins/<PluginName>/Content/<etc>/"
+
+	{
+		int count = 0;
+		while (RightStr.RemoveFromStart(TEXT("../")))
+		{
+			LeftStr = +TEXT("../");
+			count++;
+		}
+
+		if (count != 3)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("ParseRootDir : Pak file mount point { \"%s\" } isn't relative to { \"/Engine/Binaries/Platform/\" }."), *MountPoint);
+			return false;
+		}
+	}
+
+	// LeftStr	= "../../../"
+	// RightStr = "<ProjectName>/Content/<etc>/" or "<ProjectName>/Plugins/<PluginName>/Content/<etc>/"
+
+	if (RightStr.IsEmpty())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("ParseRootDir : Pak file mount point { \"%s\" } is the root directory"), *MountPoint);
+		return false;
+	}
+	verify(RightStr.Split(TEXT("/"), &LeftStr, &RightStr));
+	check(!LeftStr.IsEmpty());
+
+	// LeftStr	= "<ProjectName>"
+	// RightStr = "Content/<etc>/" or "Plugins/<PluginName>/Content/<etc>/"
+
+	if (RightStr.IsEmpty())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("ParseRootDir : Pak file mount point { \"%s\" } is at project directory level."), *MountPoint);
+		return false;
+	}
+	verify(RightStr.Split(TEXT("/"), &LeftStr, &RightStr));
+	check(!LeftStr.IsEmpty());
+
+	// LeftStr	= "Content" or "Plugins"
+	// RightStr = <etc> or <PluginName>/Content/<etc>/"
+
+	if (LeftStr.Equals(TEXT("Plugins")))
+	{
+		if (RightStr.IsEmpty())
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("ParseRootDir : Pak file mount point { \"%s\" } is at the Plugins directory level: "), *MountPoint);
+			return false;
+		}
+
+		verify(RightStr.Split(TEXT("/"), &LeftStr, &RightStr));
+		check(!LeftStr.IsEmpty());
+
+		if (RightStr.IsEmpty())
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("ParseRootDir : Pak file mount point { \"%s\" } is not within the plugin's content folder."), *MountPoint);
+			return false;
+		}
+
+		// LeftStr	= "<PluginName>"
+		// RightStr = "Content/<etc>/"
+
+		FString PluginName = LeftStr;
+		verify(RightStr.Split(TEXT("/"), &LeftStr, &RightStr));
+		check(!LeftStr.IsEmpty());
+
+		// LeftStr	= "Content"
+		// RightStr = "<etc>/"
+
+		if (LeftStr.Equals(TEXT("Content")))
+		{
+			// Root should be "/<PluginName>/<etc>/"
+			Result = FPaths::RemoveDuplicateSlashes(FString::Printf(TEXT("/%s/%s/"), *PluginName, *RightStr));
+			return true;
+		}
+
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("ParseRootDir : Pak file mount point { \"%s\" } is not within the plugin's content folder."), *MountPoint);
+		return false;
+	}
+
+	else if (LeftStr.Equals(TEXT("Content")))
+	{
+		// Root should be "/Game/<etc>/"
+		Result = FPaths::RemoveDuplicateSlashes(FString::Printf(TEXT("/Game/%s/"), *RightStr));
+		return true;
+	}
+
+	UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("ParseRootDir : Pak file mount point { \"%s\" } is not within the content folder."), *MountPoint);
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+int32 FChunkDownloaderCustom::FlushCache()
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	// wait for all mounts to finish
+	WaitForMounts();
+
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Flushing chunk caches at %s"), *CacheFolder);
+	int FilesDeleted = 0, FilesSkipped = 0;
+	for (const auto& It : Chunks)
+	{
+		const TSharedRef<FChunk>& Chunk = It.Value;
+		check(Chunk->MountTask == nullptr); // we waited for mounts
+
+		// cancel background downloads
+		bool bDownloadPending = false;
+		for (const TSharedRef<FPakFileRecord>& PakFile : Chunk->PakFiles)
+		{
+			if ((PakFile->Download.IsValid() && !PakFile->Download->HasCompleted()) || TransfersInFlight.Contains(PakFile->Entry.FileName))
+			{
+				// skip paks that are being downloaded (or still being written by a canceled transfer)
+				bDownloadPending = true;
+				break;
+			}
+		}
+
+		// skip chunks that have a foreground download pending
+		if (bDownloadPending)
+		{
+			for (const TSharedRef<FPakFileRecord>& PakFile : Chunk->PakFiles)
+			{
+				if (PakFile->SizeOnDisk > 0)
+				{
+					// log that we skipped this one
+					UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Could not flush %s (chunk %d) due to download in progress."), *PakFile->Entry.FileName, Chunk->ChunkId);
+					++FilesSkipped;
+				}
+			}
+		}
+		else
+		{
+			// delete paks
+			for (const TSharedRef<FPakFileRecord>& PakFile : Chunk->PakFiles)
+			{
+				if (PakFile->SizeOnDisk > 0 && !PakFile->bIsEmbedded)
+				{
+					// log that we deleted this one
+					FString FullPathOnDisk = CacheFolder / PakFile->Entry.FileName;
+					if (ensure(FileManager.Delete(*FullPathOnDisk)))
+					{
+						UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Deleted %s (chunk %d)."), *FullPathOnDisk, Chunk->ChunkId);
+						++FilesDeleted;
+
+						// flag uncached (may have been partial)
+						PakFile->bIsCached = false;
+						PakFile->SizeOnDisk = 0;
+						Chunk->bStatusDirty = true;
+						PakFile->VerifyStatus = EVerifyStatus::Unverified;
+						bNeedsManifestSave = true;
+						bNeedsVerifiedManifestSave = true;
+					}
+					else
+					{
+						// log an error (best we can do)
+						UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to delete %s"), *FullPathOnDisk);
+						++FilesSkipped;
+					}
+				}
+			}
+		}
+	}
+
+	// resave the manifest
+	SaveLocalManifest(false);
+	CheckPrefetchedChunks();
+
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Chunk cache flush complete. %d files deleted. %d files skipped."), FilesDeleted, FilesSkipped);
+	return FilesSkipped;
+}
+
+int32 FChunkDownloaderCustom::ValidateCache()
+{
+	// wait for all mounts to finish
+	WaitForMounts();
+
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Starting inline chunk validation."));
+	int ValidFiles = 0, InvalidFiles = 0, SkippedFiles = 0, PreviouslyVerifiedFiles = 0;
+	for (const auto& It : PakFiles)
+	{
+		const TSharedRef<FPakFileRecord>& PakFile = It.Value;
+		if (PakFile->bIsCached && !PakFile->bIsEmbedded)
+		{
+			// the background verification will take care of this one
+			if (PakFile->VerifyStatus == EVerifyStatus::Verifying)
+			{
+				++SkippedFiles;
+				continue;
+			}
+
+			// we know how to validate certain hash versions
+			bool bFileIsValid = false;
+			if (CanVerifyPakFile(*PakFile))
+			{
+				// no need to hash files that were verified and haven't been touched since
+				if (IsPakFileVerified(*PakFile))
+				{
+					UE_LOG(LogChunkDownloaderCustom, Log, TEXT("%s was verified at %s."), *PakFile->Entry.FileName, *PakFile->VerifiedAt.ToString());
+					++PreviouslyVerifiedFiles;
+					++ValidFiles;
+					continue;
+				}
+
+				// check the sha1 hash
+				bFileIsValid = CheckFileSha1Hash(CacheFolder / PakFile->Entry.FileName, PakFile->Entry.FileVersion);
+			}
+			else
+			{
+				// we don't know how to validate this version format
+				UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Unable to validate %s with version '%s'."), *PakFile->Entry.FileName, *PakFile->Entry.FileVersion);
+				++SkippedFiles;
+				continue;
+			}
+
+			// see if it's valid or not
+			if (bFileIsValid)
+			{
+				// log valid
+				UE_LOG(LogChunkDownloaderCustom, Log, TEXT("%s matches hash '%s'."), *PakFile->Entry.FileName, *PakFile->Entry.FileVersion);
+				MarkPakFileVerified(*PakFile);
+				++ValidFiles;
+			}
+			else
+			{
+				// log invalid
+				UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("%s does NOT match hash '%s'."), *PakFile->Entry.FileName, *PakFile->Entry.FileVersion);
+				++InvalidFiles;
+
+				// delete invalid files (or repair them if they were mounted lazily)
+				InvalidatePakFile(PakFile);
+			}
+		}
+	}
+
+	// resave the manifest
+	SaveLocalManifest(false);
+
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Chunk validation complete. %d valid (%d previously verified), %d invalid, %d skipped"), ValidFiles, PreviouslyVerifiedFiles, InvalidFiles, SkippedFiles);
+	return InvalidFiles;
+}
+
+void FChunkDownloaderCustom::BeginLoadingMode(const FCallback& Callback)
+{
+	check(Callback); // you can't start loading mode without a valid callback
+
+	// see if we're already in loading mode
+	if (PostLoadCallbacks.Num() > 0)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("JoinLoadingMode"));
+
+		// just wait on the existing loading mode to finish
+		PostLoadCallbacks.Add(Callback);
+		return;
+	}
+
+	// start loading mode
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("BeginLoadingMode"));
+#if PLATFORM_ANDROID || PLATFORM_IOS
+	FPlatformApplicationMisc::ControlScreensaver(FPlatformApplicationMisc::Disable);
+#endif
+
+	// don't make the loading screen wait on the background install or on speculative prefetches
+	PauseBackgroundInstall();
+	PausePrefetches();
+
+	// reset stats
+	LoadingModeStats.LastError = FText();
+	LoadingModeStats.BytesDownloaded = 0;
+	LoadingModeStats.FilesDownloaded = 0;
+	LoadingModeStats.ChunksMounted = 0;
+	LoadingModeStats.LoadingStartTime = FDateTime::UtcNow();
+	ComputeLoadingStats(); // recompute before binding callback in case there's nothing queued yet
+
+	// set the callback
+	PostLoadCallbacks.Add(Callback);
+	LoadingCompleteLatch = 0;
+
+	// compute again next frame (if nothing's queued by then, we'll fire the callback
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThisPtr](float dts) {
+		TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+		if (!SharedThis.IsValid() || SharedThis->PostLoadCallbacks.Num() <= 0)
+		{
+			return false; // stop ticking
+		}
+		return SharedThis->UpdateLoadingMode();
+	}));
+}
+
+const FChunkDownloaderCustom::FChunk* FChunkDownloaderCustom::FindInspectableChunk(int32 ChunkId) const
+{
+	// look up the chunk
+	const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+	if (ChunkPtr == nullptr || (*ChunkPtr)->PakFiles.Num() <= 0)
+	{
+		// a chunk that doesn't exist or one with no pak files are both considered "complete" for the purposes of this call
+		// use GetChunkStatus to differentiate from chunks that mounted successfully
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring chunk content inspection request for chunk %d (no mapped pak files)."), ChunkId);
+		return nullptr;
+	}
+	const FChunk& Chunk = **ChunkPtr;
+
+	// see if we're mounted already
+	if (!Chunk.bIsMounted)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring chunk content inspection request for chunk %d (chunk is unmounted)."), ChunkId);
+		return nullptr;
+	}
+
+	// see if paks are registered as well.
+	if (!Chunk.IsRegistered())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring chunk content inspection request for chunk %d (chunk is unregistered)."), ChunkId);
+		return nullptr;
+	}
+
+	return &Chunk;
+}
+
+void FChunkDownloaderCustom::FContentIndex::AddFile(FString&& Path, int64 Offset, int64 Size)
+{
+	const int32 FileIndex = Files.Num();
+	FChunkFile& Entry = Files.AddDefaulted_GetRef();
+	Entry.Path = MoveTemp(Path);
+	Entry.Offset = Offset;
+	Entry.Size = Size;
+
+	// the package name is the path without its extension
+	int32 LeafStart = INDEX_NONE;
+	Entry.Path.FindLastChar(TEXT('/'), LeafStart);
+	++LeafStart;
+	int32 ExtensionStart = INDEX_NONE;
+	if (Entry.Path.FindLastChar(TEXT('.'), ExtensionStart) && ExtensionStart > LeafStart)
+	{
+		const TCHAR* Extension = *Entry.Path + ExtensionStart + 1;
+		if (FCString::Stricmp(Extension, TEXT("uasset")) == 0)
+		{
+			Entry.Type = EChunkFileType::Asset;
+		}
+		else if (FCString::Stricmp(Extension, TEXT("umap")) == 0)
+		{
+			Entry.Type = EChunkFileType::Map;
+		}
+	}
+	else
+	{
+		ExtensionStart = Entry.Path.Len();
+	}
+	Entry.PackageName = FName(ExtensionStart, *Entry.Path);
+	FilesByLeafName.FindOrAdd(FName(ExtensionStart - LeafStart, *Entry.Path + LeafStart)).Add(FileIndex);
+}
+
+void FChunkDownloaderCustom::FContentIndex::Reset()
+{
+	Files.Empty();
+	FilesByLeafName.Empty();
+}
+
+const FChunkDownloaderCustom::FChunkFile* FChunkDownloaderCustom::FContentIndex::FindPackage(FStringView PackageSuffix, bool bCookedOnly) const
+{
+	// ignore leading and trailing slashes ("/Maps/Level/" is the same as "Maps/Level")
+	while (PackageSuffix.StartsWith(TEXT('/')))
+	{
+		PackageSuffix.RightChopInline(1);
+	}
+	while (PackageSuffix.EndsWith(TEXT('/')))
+	{
+		PackageSuffix.LeftChopInline(1);
+	}
+	if (PackageSuffix.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	// hash lookup on the last segment, then only compare the full suffix of the few files that share it
+	int32 LeafStart = INDEX_NONE;
+	PackageSuffix.FindLastChar(TEXT('/'), LeafStart);
+	const FStringView LeafName = PackageSuffix.RightChop(LeafStart + 1);
+	const TArray<int32>* Candidates = FilesByLeafName.Find(FName(LeafName.Len(), LeafName.GetData(), FNAME_Find));
+	if (Candidates == nullptr)
+	{
+		return nullptr;
+	}
+
+	TStringBuilder<FName::StringBufferSize> PackageStr;
+	for (int32 FileIndex : *Candidates)
+	{
+		const FChunkFile& File = Files[FileIndex];
+		if (bCookedOnly && !File.IsCooked())
+		{
+			continue;
+		}
+
+		// match whole segments only
+		PackageStr.Reset();
+		File.PackageName.AppendString(PackageStr);
+		const FStringView PackageView = PackageStr.ToView();
+		if (PackageView.EndsWith(PackageSuffix, ESearchCase::CaseSensitive) &&
+			(PackageView.Len() == PackageSuffix.Len() || PackageView[PackageView.Len() - PackageSuffix.Len() - 1] == TEXT('/')))
+		{
+			return &File;
+		}
+	}
+	return nullptr;
+}
+
+void FChunkDownloaderCustom::BuildContentIndex(const FPakFile& Pak, FContentIndex& OutContent)
+{
+	// the mount point may not be registered yet (batches register on the game thread), so parse it the same way registration does
+	FString RootDir;
+	const FString& MountPoint = Pak.GetMountPoint();
+	if (!FPackageName::TryConvertFilenameToLongPackageName(MountPoint, RootDir) && !ParseRootDir(MountPoint, RootDir))
+	{
+		return;
+	}
+
+	OutContent.Reset();
+	OutContent.Files.Reserve(Pak.GetNumFiles());
+	const int32 PakVersion = Pak.GetInfo().Version;
+	for (FPakFile::FFilenameIterator File(Pak); File; ++File)
+	{
+		// the entry data follows a copy of its header, and takes its compressed size on disk (padded if encrypted)
+		const FPakEntry& Entry = File.Info();
+		if (Entry.IsDeleteRecord())
+		{
+			OutContent.AddFile(RootDir / File.Filename());
+		}
+		else
+		{
+			const int64 StoredSize = Entry.IsEncrypted() ? Align(Entry.CompressedSize, FAES::AESBlockSize) : Entry.CompressedSize;
+			OutContent.AddFile(RootDir / File.Filename(), Entry.Offset, Entry.GetSerializedSize(PakVersion) + StoredSize);
+		}
+	}
+	OutContent.Files.Shrink();
+	OutContent.FilesByLeafName.Shrink();
+}
+
+bool FChunkDownloaderCustom::ForEachChunkFile(int32 ChunkId, TFunctionRef<bool(const FChunkFile&)> Predicate, bool bCookedOnly) const
+{
+	const FChunk* Chunk = FindInspectableChunk(ChunkId);
+	if (Chunk == nullptr)
+	{
+		return false;
+	}
+
+	bool bResult = false;
+	for (const TSharedRef<FPakFileRecord>& PakFile : Chunk->PakFiles)
+	{
+		for (const FChunkFile& File : PakFile->Content.Files)
+		{
+			if (!bCookedOnly || File.IsCooked())
+			{
+				bResult = true;
+				if (!Predicate(File))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return bResult;
+}
+
+const FChunkDownloaderCustom::FChunkFile* FChunkDownloaderCustom::FindChunkFile(int32 ChunkId, FStringView PackageSuffix, bool bCookedOnly) const
+{
+	const FChunk* Chunk = FindInspectableChunk(ChunkId);
+	if (Chunk == nullptr)
+	{
+		return nullptr;
+	}
+
+	// first pak wins, same as iterating the whole chunk
+	for (const TSharedRef<FPakFileRecord>& PakFile : Chunk->PakFiles)
+	{
+		if (const FChunkFile* File = PakFile->Content.FindPackage(PackageSuffix, bCookedOnly))
+		{
+			return File;
+		}
+	}
+	return nullptr;
+}
+
+void FChunkDownloaderCustom::PrewarmChunk(int32 ChunkId, const TArray<FName>& PackageNames, const FPrewarmCallback& Callback)
+{
+	const FChunk* Chunk = FindInspectableChunk(ChunkId);
+	if (Chunk == nullptr)
+	{
+		if (Callback)
+		{
+			DeferWork(TEXT("Prewarm callback"), [Callback]() {
+				Callback(-1, 0);
+			});
+		}
+		return;
+	}
+
+	// collect the byte ranges of every file of the requested packages (.uasset/.umap, .uexp, .ubulk...), as indexed on the mount worker
+	static const int64 MAX_RANGE_GAP = 64 * 1024;
+	const TSet<FName> PackageSet(PackageNames);
+	TArray<FPrewarmFile> Files;
+	int64 BytesBudget = PrewarmBudgetBytes;
+	for (const TSharedRef<FPakFileRecord>& PakFile : Chunk->PakFiles)
+	{
+		if (!PakFile->Pak.IsValid() || BytesBudget <= 0)
+		{
+			continue;
+		}
+		TArray<TPair<int64, int64>> Ranges;
+		for (const FChunkFile& File : PakFile->Content.Files)
+		{
+			if (File.Size > 0 && (PackageSet.Num() <= 0 || PackageSet.Contains(File.PackageName)))
+			{
+				Ranges.Emplace(File.Offset, File.Size);
+			}
+		}
+		if (Ranges.Num() <= 0)
+		{
+			continue;
+		}
+
+		// small gaps are cheaper to read through than to seek over
+		Ranges.Sort([](const TPair<int64, int64>& A, const TPair<int64, int64>& B) { return A.Key < B.Key; });
+		FPrewarmFile& WarmFile = Files.AddDefaulted_GetRef();
+		WarmFile.FullPathOnDisk = PakFile->Pak->GetFilename();
+		for (const TPair<int64, int64>& Range : Ranges)
+		{
+			TPair<int64, int64>* Last = WarmFile.Ranges.Num() > 0 ? &WarmFile.Ranges.Last() : nullptr;
+			if (Last != nullptr && Range.Key <= Last->Key + Last->Value + MAX_RANGE_GAP)
+			{
+				const int64 End = FMath::Max(Last->Key + Last->Value, Range.Key + Range.Value);
+				BytesBudget -= End - (Last->Key + Last->Value);
+				Last->Value = End - Last->Key;
+			}
+			else
+			{
+				WarmFile.Ranges.Add(Range);
+				BytesBudget -= Range.Value;
+			}
+			if (BytesBudget <= 0)
+			{
+				// trim the last range to fit
+				WarmFile.Ranges.Last().Value += BytesBudget;
+				break;
+			}
+		}
+	}
+
+	if (Files.Num() <= 0)
+	{
+		if (Callback)
+		{
+			DeferWork(TEXT("Prewarm callback"), [Callback]() {
+				Callback(0, 0);
+			});
+		}
+		return;
+	}
+
+	int64 NumBytes = 0;
+	int32 NumRanges = 0;
+	for (const FPrewarmFile& File : Files)
+	{
+		NumRanges += File.Ranges.Num();
+		for (const TPair<int64, int64>& Range : File.Ranges)
+		{
+			NumBytes += Range.Value;
+		}
+	}
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Prewarming %lld bytes of chunk %d in %d ranges."), NumBytes, ChunkId, NumRanges);
+	const double StartTime = FPlatformTime::Seconds();
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	AsyncPool(GIOThreadPool != nullptr ? *GIOThreadPool : *GThreadPool, [WeakThisPtr, Files = MoveTemp(Files), ChunkId, StartTime, Callback]() {
+		int64 BytesRead = 0;
+		int64 BytesAdvised = 0;
+		for (const FPrewarmFile& File : Files)
+		{
+			BytesRead += PrewarmFile(File, BytesAdvised);
+		}
+
+		// report back within the game thread work budget
+		AsyncTask(ENamedThreads::GameThread, [WeakThisPtr, ChunkId, BytesRead, BytesAdvised, Seconds = FPlatformTime::Seconds() - StartTime, Callback]() {
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d prewarmed, %lld bytes read and %lld bytes advised in %.1f ms."), ChunkId, BytesRead, BytesAdvised, Seconds * 1000.0);
+			TSharedPtr<FChunkDownloaderCustom> Downloader = WeakThisPtr.Pin();
+			if (Downloader.IsValid() && Callback)
+			{
+				Downloader->DeferWork(TEXT("Prewarm callback"), [Callback, BytesRead, BytesAdvised]() {
+					Callback(BytesRead, BytesAdvised);
+				});
+			}
+		});
+	}, nullptr, EQueuedWorkPriority::Low);
+}
+
+int64 FChunkDownloaderCustom::PrewarmFile(const FPrewarmFile& File, int64& OutBytesAdvised)
+{
+	int64 BytesRead = 0;
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+	// let the kernel read ahead into the page cache, without copying anything to us (it may not have by the time we return)
+	const FString AbsolutePath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*File.FullPathOnDisk);
+	int Fd = open(TCHAR_TO_UTF8(*AbsolutePath), O_RDONLY);
+	if (Fd >= 0)
+	{
+		for (const TPair<int64, int64>& Range : File.Ranges)
+		{
+			if (posix_fadvise(Fd, Range.Key, Range.Value, POSIX_FADV_WILLNEED) == 0)
+			{
+				OutBytesAdvised += Range.Value;
+			}
+		}
+		close(Fd);
+		return BytesRead;
+	}
+#endif
+
+	// read the ranges and throw the data away, all we want is for it to end up in the OS file cache
+	IFileHandle* FilePtr = IPlatformFile::GetPlatformPhysical().OpenRead(*File.FullPathOnDisk);
+	if (FilePtr == nullptr)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Unable to open %s for prewarming."), *File.FullPathOnDisk);
+		return 0;
+	}
+
+	static const int64 BUFFER_SIZE = 1024 * 1024;
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(BUFFER_SIZE);
+	for (const TPair<int64, int64>& Range : File.Ranges)
+	{
+		if (!FilePtr->Seek(Range.Key))
+		{
+			break;
+		}
+		for (int64 Remaining = Range.Value; Remaining > 0;)
+		{
+			const int64 ReadSize = FMath::Min(Remaining, BUFFER_SIZE);
+			if (!FilePtr->Read(Buffer.GetData(), ReadSize))
+			{
+				break;
+			}
+			Remaining -= ReadSize;
+			BytesRead += ReadSize;
+		}
+	}
+	delete FilePtr;
+	return BytesRead;
+}
+
+bool FChunkDownloaderCustom::InspectChunkContent(int32 ChunkId, const TFunction<bool(const FString&, const FString&)>& Predicate, bool bCookedOnly) const
+{
+	// make sure predicate is valid
+	if (!Predicate)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring chunk content inspection request for chunk %d (no predicate function provided)."), ChunkId);
+		return false;
+	}
+
+	// one buffer for all the package names
+	FString PackageStr;
+	return ForEachChunkFile(ChunkId, [&Predicate, &PackageStr](const FChunkFile& File)
+		{
+			File.PackageName.ToString(PackageStr);
+			return Predicate(PackageStr, File.Path);
+		}, bCookedOnly);
+}
+
+int32 FChunkDownloaderCustom::ScanAssetsInChunk(int32 ChunkId) const
+{
+	return ScanAssetsInChunks({ ChunkId });
+}
+
+int32 FChunkDownloaderCustom::PrepareAssetScan(const TArray<int32>& ChunkIds, bool bAllowRegistryFragments, TSet<FString>& OutPackageStrings) const
+{
+	int32 Result = 0;
+	bool bAnyInspected = false;
+	for (int32 ChunkId : ChunkIds)
+	{
+		TSet<FName> ChunkPackageNames;
+		if (!ForEachChunkFile(ChunkId, [&ChunkPackageNames](const FChunkFile& File)
+			{
+				ChunkPackageNames.Add(File.PackageName);
+				return true;
+			}))
+		{
+			continue;
+		}
+		bAnyInspected = true;
+
+		// the chunk's serialized asset registry was merged as it mounted if it has one, it's much cheaper than reading every package
+		const FChunk& Chunk = *Chunks.FindChecked(ChunkId);
+		if (bAllowRegistryFragments && Chunk.NumRegistryFragmentAssets != INDEX_NONE)
+		{
+			Result += Chunk.NumRegistryFragmentAssets;
+			continue;
+		}
+		for (const FName& PackageName : ChunkPackageNames)
+		{
+			OutPackageStrings.Add(PackageName.ToString());
+		}
+	}
+
+	// returns the number of assets merged from fragments, the remaining files still need to be scanned
+	return bAnyInspected ? Result : INDEX_NONE;
+}
+
+int32 FChunkDownloaderCustom::ScanAssetsInChunks(const TArray<int32>& ChunkIds, bool bAllowRegistryFragments) const
+{		
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	
+	TSet<FString> PackageStrings;
+	int32 Result = PrepareAssetScan(ChunkIds, bAllowRegistryFragments, PackageStrings);
+	if (Result == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	// scan whatever is left
+	if (PackageStrings.Num() > 0)
+	{
+
+
+#if !UE_BUILD_SHIPPING
+		// Log stuff in non-shipping builds
+		FString ChunkList = FString::JoinBy(ChunkIds, TEXT(", "), [](int32 ChunkId) { return FString::FromInt(ChunkId); });
+		auto LogHandle = AssetRegistry.OnAssetAdded().AddLambda([&ChunkList](const FAssetData& Asset)
+			{
+				UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Asset %s of type %s in chunk %s was added to AssetRegistry."),
+				*Asset.AssetName.ToString(), *Asset.AssetClassPath.ToString(), *ChunkList);
+			});
+#endif
+
+		// Scan the paths through the AssetRegistry to make sure it is aware of them.
+		// This is a costly function, but we are scanning only the actual files, so it should be mitigated unless searching for all files in a very heavy pak.
+		auto Handle = AssetRegistry.OnAssetAdded().AddLambda([&Result](const FAssetData&) { Result++; });
+		AssetRegistry.ScanFilesSynchronous(PackageStrings.Array());
+		AssetRegistry.OnAssetAdded().Remove(Handle);
+
+#if !UE_BUILD_SHIPPING
+		// Remove logging lambda
+		AssetRegistry.OnAssetAdded().Remove(LogHandle);
+#endif		
+	}
+
+	return Result;
+}
+
+void FChunkDownloaderCustom::ScanAssetsInChunksAsync(const TArray<int32>& ChunkIds, const FCallback& Callback)
+{
+	// fragments are merged right away, only the file scan is spread over frames
+	TSet<FString> PackageStrings;
+	int32 NumAssets = PrepareAssetScan(ChunkIds, true, PackageStrings);
+	if (NumAssets == INDEX_NONE)
+	{
+		ExecuteNextTick(Callback, false);
+		return;
+	}
+
+	TSharedRef<FAssetScan> Scan = MakeShared<FAssetScan>();
+	Scan->ChunkIds = ChunkIds;
+	Scan->PackageStrings = PackageStrings.Array();
+	Scan->NumAssets = NumAssets;
+	Scan->Callback = Callback;
+	AssetScans.Add(Scan);
+
+	// start the ticker if needed
+	if (!AssetScanTicker.IsValid())
+	{
+		AssetScanTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FChunkDownloaderCustom::UpdateAssetScans));
+	}
+}
+
+bool FChunkDownloaderCustom::UpdateAssetScans(float dts)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	// scan slices while the game thread work budget lasts (at least one slice per frame so scans always progress)
+	do
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		TSharedRef<FAssetScan> Scan = AssetScans[0];
+		const int32 NumToScan = FMath::Min(AssetScanSliceSize, Scan->PackageStrings.Num() - Scan->NumScanned);
+		if (NumToScan > 0)
+		{
+			TArray<FString> Slice(Scan->PackageStrings.GetData() + Scan->NumScanned, NumToScan);
+			auto Handle = AssetRegistry.OnAssetAdded().AddLambda([&Scan](const FAssetData&) { Scan->NumAssets++; });
+			AssetRegistry.ScanFilesSynchronous(Slice);
+			AssetRegistry.OnAssetAdded().Remove(Handle);
+			Scan->NumScanned += NumToScan;
+			OnAssetScanProgress.Broadcast(Scan->ChunkIds, Scan->NumScanned, Scan->PackageStrings.Num());
+		}
+
+		// done with this one
+		if (Scan->NumScanned >= Scan->PackageStrings.Num())
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("%d assets added to Asset Registry from %d chunks (%d files scanned asynchronously)."), Scan->NumAssets, Scan->ChunkIds.Num(), Scan->NumScanned);
+			AssetScans.RemoveAt(0);
+			ExecuteNextTick(Scan->Callback, true);
+		}
+		GameThreadWork->Record(TEXT("Asset scan"), StartTime);
+	} while (AssetScans.Num() > 0 && GameThreadWork->HasBudget());
+
+	bool bScansPending = AssetScans.Num() > 0;
+	if (!bScansPending)
+	{
+		AssetScanTicker.Reset();
+	}
+	return bScansPending; // keep ticking
+}
+
+void FChunkDownloaderCustom::CancelAssetScans()
+{
+	if (AssetScanTicker.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(AssetScanTicker);
+		AssetScanTicker.Reset();
+	}
+
+	// whatever was scanned so far stays in the asset registry
+	TArray<TSharedRef<FAssetScan>> CanceledScans = MoveTemp(AssetScans);
+	for (const TSharedRef<FAssetScan>& Scan : CanceledScans)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Canceling asset scan of %d chunks (%d of %d files scanned)."), Scan->ChunkIds.Num(), Scan->NumScanned, Scan->PackageStrings.Num());
+		ExecuteNextTick(Scan->Callback, false);
+	}
+}
+
+bool FChunkDownloaderCustom::GetChunkContent(int32 ChunkId, TArray<TSoftObjectPtr<UObject>>& Content,
+	bool bPreScanAssets,
+	const FName& inPackageName,
+	const FName& inPackagePath, bool bRecursivePath,
+	const TSubclassOf<UObject>& inClass, bool bRecursiveClass
+) const
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	
+	FARFilter Filter;			// Filter to find desired assets in AssetRegistry	
+	TArray<FName>& PackageNames = Filter.PackageNames;
+	
+	// an asset registry scan needs the whole chunk, with or without a specific package
+	TArray<FString> PackageStrings;
+	if (bPreScanAssets || inPackageName.IsNone())
+	{
+		if (!ForEachChunkFile(ChunkId, [bPreScanAssets, bAllPackages = inPackageName.IsNone(), &PackageNames, &PackageStrings](const FChunkFile& File)
+			{
+				if (bPreScanAssets)
+				{
+					PackageStrings.Add(File.PackageName.ToString());
+				}
+				if (bAllPackages)
+				{
+					PackageNames.Add(File.PackageName);
+				}
+				return true;
+			}))
+		{
+			return false;
+		}
+	}
+	else if (FindInspectableChunk(ChunkId) == nullptr)
+	{
+		return false;
+	}
+
+	// We want to loosely match the PackageName if possible (i.e. "Maps/Level" matches "/Game/Maps/Level").
+	if (!inPackageName.IsNone())
+	{
+		if (const FChunkFile* File = FindChunkFile(ChunkId, inPackageName.ToString()))
+		{
+			PackageNames.Add(File->PackageName);
+		}
+	}
+
+	if (PackageStrings.Num() > 0)
+	{
+
+#if !UE_BUILD_SHIPPING
+		// Log stuff in non-shipping builds
+		auto LogHandle = AssetRegistry.OnAssetAdded().AddLambda([ChunkId](const FAssetData& Asset)
+			{
+				UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Asset %s of type %s in chunk %d was added to AssetRegistry."),
+				*Asset.AssetName.ToString(), *Asset.AssetClassPath.ToString(), ChunkId);
+			});
+#endif
+
+		// Scan the paths through the AssetRegistry to make sure it is aware of them.
+		// This is a costly function, but we are scanning only the actual files, so it should be mitigated unless searching for all files in a very heavy pak.
+		AssetRegistry.ScanFilesSynchronous(PackageStrings);
+
+#if !UE_BUILD_SHIPPING
+		// Remove logging lambda
+		AssetRegistry.OnAssetAdded().Remove(LogHandle);
+#endif
+
+	}
+
+	if (PackageNames.Num() > 0)
+	{
+		// Finalize populating filter data
+		if (IsValid(inClass))
+		{
+			Filter.ClassPaths.Add(FSoftClassPath(inClass).GetAssetPath());
+			Filter.bRecursiveClasses = bRecursiveClass;
+		}
+
+		if (!inPackagePath.IsNone())
+		{
+			Filter.PackageNames.Add(inPackagePath);
+			Filter.bRecursivePaths = bRecursivePath;
+		}
+
+		// Enumerate assets and convert to soft object pointers
+		AssetRegistry.EnumerateAssets(Filter, [&Content](const FAssetData& Asset)
+			{
+				Content.AddUnique(TSoftObjectPtr<UObject>(Asset.GetSoftObjectPath()));
+				return true;
+			});
+	}
+
+	return Content.Num() > 0;
+}
+
+
+bool FChunkDownloaderCustom::UpdateLoadingMode()
+{
+	// recompute loading stats
+	ComputeLoadingStats();
+
+	// check for the end of loading mode
+	if (LoadingModeStats.FilesDownloaded >= LoadingModeStats.TotalFilesToDownload &&
+		LoadingModeStats.ChunksMounted >= LoadingModeStats.TotalChunksToMount)
+	{
+		// make sure loading's been done for at least 2 frames before firing the callback
+		// this adds a negligible amount of time to the loading screen but gives dependent loads a chance to queue
+		static const int32 NUM_CONSECUTIVE_IDLE_FRAMES_FOR_LOADING_COMPLETION = 5;
+		if (++LoadingCompleteLatch >= NUM_CONSECUTIVE_IDLE_FRAMES_FOR_LOADING_COMPLETION)
+		{
+			// end loading mode
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("EndLoadingMode (%d files downloaded, %d chunks mounted)"), LoadingModeStats.FilesDownloaded, LoadingModeStats.ChunksMounted);
+#if PLATFORM_ANDROID || PLATFORM_IOS
+			FPlatformApplicationMisc::ControlScreensaver(FPlatformApplicationMisc::Enable);
+#endif
+
+			// fire any loading mode completion callbacks
+			TArray<FCallback> Callbacks = MoveTemp(PostLoadCallbacks);
+			if (Callbacks.Num() > 0)
+			{
+				PostLoadCallbacks.Empty(); // shouldn't be necessary due to MoveTemp but just in case
+				for (const auto& Callback : Callbacks)
+				{
+					Callback(LoadingModeStats.LastError.IsEmpty());
+				}
+			}
+			return false; // stop ticking
+		}
+	}
+	else
+	{
+		// reset the latch
+		LoadingCompleteLatch = 0;
+	}
+
+	return true; // keep ticking
+}
+
+void FChunkDownloaderCustom::ComputeLoadingStats()
+{
+	// everything here is tracked as it happens, so this doesn't depend on how much is queued
+	LoadingModeStats.TotalBytesToDownload = LoadingModeStats.BytesDownloaded + DownloadRequestBytesRemaining;
+	LoadingModeStats.TotalFilesToDownload = LoadingModeStats.FilesDownloaded + DownloadRequests.Num();
+	LoadingModeStats.TotalChunksToMount = LoadingModeStats.ChunksMounted + PendingMountTasks.Num();
+}
+
+void FChunkDownloaderCustom::ExecuteNextTick(const FCallback& Callback, bool bSuccess)
+{
+	if (Callback)
+	{
+		DeferWork(TEXT("Callback"), [Callback, bSuccess]() {
+			Callback(bSuccess);
+		});
+	}
+}
+
+void FChunkDownloaderCustom::DeferWork(const TCHAR* Name, TUniqueFunction<void()>&& Work)
+{
+	check(IsInGameThread());
+	FGameThreadWork::FItem Item;
+	Item.Name = Name;
+	Item.Frame = GFrameCounter;
+	Item.Work = MoveTemp(Work);
+	GameThreadWork->Items.Enqueue(MoveTemp(Item));
+	++GameThreadWork->NumItems;
+	GameThreadWork->Stats.MaxQueuedItems = FMath::Max(GameThreadWork->Stats.MaxQueuedItems, GameThreadWork->NumItems);
+
+	if (!GameThreadWork->Ticker.IsValid())
+	{
+		TSharedRef<FGameThreadWork> Queue = GameThreadWork;
+		GameThreadWork->Ticker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Queue](float dts) {
+			return Queue->Tick();
+		}));
+	}
+}
+
+const FChunkDownloaderCustom::FGameThreadWorkStats& FChunkDownloaderCustom::GetGameThreadWorkStats() const
+{
+	return GameThreadWork->Stats;
+}
+
+void FChunkDownloaderCustom::TryLoadBuildManifest(int32 TryNumber)
+{
+	// load the local build manifest
+	TMap<FString, FString> CachedManifestProps;
+	TArray<FPakManifestEntry> CachedManifest = ParseManifest(CacheFolder / CACHED_BUILD_MANIFEST, &CachedManifestProps);
+
+	// see if the BUILD_ID property matches
+	if (CachedManifestProps.FindOrAdd(BUILD_ID_KEY) != ContentBuildId)
+	{
+		// if we have no CDN configured, we're done
+		if (BuildBaseUrls.Num() <= 0)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to download build manifest. No CDN urls configured."));
+			LoadingModeStats.LastError = LOCTEXT("UnableToDownloadManifest", "Unable to download build manifest. (NoCDN)");
+
+			// execute and clear the callback
+			FCallback Callback = MoveTemp(UpdateBuildCallback);
+			ExecuteNextTick(Callback, false);
+			return;
+		}
+
+		// fast path the first try
+		if (TryNumber <= 0)
+		{
+			// download it
+			TryDownloadBuildManifest(TryNumber);
+			return;
+		}
+
+		// compute delay before re-starting download
+		float SecondsToDelay = TryNumber * 5.0f;
+		if (SecondsToDelay > 60)
+		{
+			SecondsToDelay = 60;
+		}
+
+		// set a ticker to delay
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Will re-attempt manifest download in %f seconds"), SecondsToDelay);
+		TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThisPtr, TryNumber](float Unused) {
+			TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+			if (SharedThis.IsValid())
+			{
+				SharedThis->TryDownloadBuildManifest(TryNumber);
+			}
+			return false;
+		}), SecondsToDelay);
+		return;
+	}
+
+	// cached build manifest is up to date, load this one
+	LoadManifest(CachedManifest);
+	LoadContentListing();
+
+	// execute and clear the callback
+	FCallback Callback = MoveTemp(UpdateBuildCallback);
+	ExecuteNextTick(Callback, true);
+}
+
+void FChunkDownloaderCustom::TryDownloadBuildManifest(int32 TryNumber)
+{
+	check(BuildBaseUrls.Num() > 0);
+
+	// download the manifest from CDN, then load it
+	FString ManifestFileName = FString::Printf(TEXT("BuildManifest-%s.txt"), *PlatformName);
+	FString Url = BuildBaseUrls[TryNumber % BuildBaseUrls.Num()] / ManifestFileName;
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Downloading build manifest (attempt #%d) from %s"), TryNumber+1, *Url);
+
+	// download the manifest from the root CDN
+	FHttpModule& HttpModule = FModuleManager::LoadModuleChecked<FHttpModule>("HTTP");
+	check(!ManifestRequest.IsValid());
+	ManifestRequest = HttpModule.Get().CreateRequest();
+	ManifestRequest->SetURL(Url);
+	ManifestRequest->SetVerb(TEXT("GET"));
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	FString CachedManifestFullPath = CacheFolder / CACHED_BUILD_MANIFEST;
+	ManifestRequest->OnProcessRequestComplete().BindLambda([WeakThisPtr, TryNumber, CachedManifestFullPath](FHttpRequestPtr HttpRequest, FHttpResponsePtr HttpResponse, bool bSuccess) {
+		// if successful, save
+		FText LastError;
+		if (bSuccess && HttpResponse.IsValid())
+		{
+			const int32 HttpStatus = HttpResponse->GetResponseCode();
+			if (EHttpResponseCodes::IsOk(HttpStatus))
+			{
+				// Save the manifest to a file
+				if (!WriteStringAsUtf8TextFile(HttpResponse->GetContentAsString(), CachedManifestFullPath))
+				{
+					UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Failed to write manifest to '%s'"), *CachedManifestFullPath);
+					LastError = FText::Format(LOCTEXT("FailedToWriteManifest", "[Try {0}] Failed to write manifest."), FText::AsNumber(TryNumber));
+				}
+			}
+			else
+			{
+				UE_LOG(LogChunkDownloaderCustom, Error, TEXT("HTTP %d while downloading manifest from '%s'"), HttpStatus, *HttpRequest->GetURL());
+				LastError = FText::Format(LOCTEXT("ManifestHttpError_FailureCode", "[Try {0}] Manifest download failed (HTTP {1})"), FText::AsNumber(TryNumber), FText::AsNumber(HttpStatus));
+			}
+		}
+		else
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("HTTP connection issue while downloading manifest '%s'"), *HttpRequest->GetURL());
+			LastError = FText::Format(LOCTEXT("ManifestHttpError_Generic", "[Try {0}] Connection issues downloading manifest. Check your network connection..."), FText::AsNumber(TryNumber));
+		}
+
+		// try to load it
+		TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+		if (!SharedThis.IsValid())
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("FChunkDownloaderCustom was destroyed while downloading manifest '%s'"), *HttpRequest->GetURL());
+			return;
+		}
+		SharedThis->ManifestRequest.Reset();
+		SharedThis->LoadingModeStats.LastError = LastError; // ok with this clearing the error on success
+		SharedThis->TryLoadBuildManifest(TryNumber + 1);
+	});
+	ManifestRequest->ProcessRequest();
+}
+
+// the listing starts with its "$BUILD_ID = <id>" property, parsed like the manifest properties
+static bool IsContentListingForBuild(const FString& ListingText, const FString& BuildId)
+{
+	int32 LineEnd = INDEX_NONE;
+	FString FirstLine = ListingText.FindChar(TEXT('\n'), LineEnd) ? ListingText.Left(LineEnd) : ListingText;
+	FirstLine.TrimEndInline();
+
+	FString Name, Value;
+	return FirstLine.StartsWith(TEXT("$")) && FirstLine.RightChop(1).Split(TEXT(" = "), &Name, &Value) && Name == BUILD_ID_KEY && Value == BuildId;
+}
+
+void FChunkDownloaderCustom::LoadContentListing()
+{
+	// the listing is optional, and only valid for the build it was published with
+	FString ListingFullPath = CacheFolder / CACHED_CONTENT_LISTING;
+	FString ListingText;
+	if (FFileHelper::LoadFileToString(ListingText, *ListingFullPath) && IsContentListingForBuild(ListingText, ContentBuildId))
+	{
+		ApplyContentListing(ListingText);
+		return;
+	}
+
+	if (BuildBaseUrls.Num() <= 0 || ContentListingRequest.IsValid())
+	{
+		return;
+	}
+
+	// a single attempt, chunks still get indexed as they mount if there's no listing
+	FString Url = BuildBaseUrls[0] / FString::Printf(TEXT("ChunkContent-%s.txt"), *PlatformName);
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Downloading content listing from %s"), *Url);
+	FHttpModule& HttpModule = FModuleManager::LoadModuleChecked<FHttpModule>("HTTP");
+	ContentListingRequest = HttpModule.Get().CreateRequest();
+	ContentListingRequest->SetURL(Url);
+	ContentListingRequest->SetVerb(TEXT("GET"));
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	FString ExpectedBuildId = ContentBuildId;
+	ContentListingRequest->OnProcessRequestComplete().BindLambda([WeakThisPtr, ListingFullPath, ExpectedBuildId](FHttpRequestPtr HttpRequest, FHttpResponsePtr HttpResponse, bool bSuccess) {
+		TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+		if (!SharedThis.IsValid())
+		{
+			return;
+		}
+		SharedThis->ContentListingRequest.Reset();
+
+		if (!bSuccess || !HttpResponse.IsValid() || !EHttpResponseCodes::IsOk(HttpResponse->GetResponseCode()))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("No content listing available from '%s', chunks will be indexed as they mount."), *HttpRequest->GetURL());
+			return;
+		}
+
+		// the build may have changed while we were downloading
+		FString ListingText = HttpResponse->GetContentAsString();
+		if (SharedThis->ContentBuildId != ExpectedBuildId || !IsContentListingForBuild(ListingText, ExpectedBuildId))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring content listing from '%s' (doesn't match build %s)."), *HttpRequest->GetURL(), *SharedThis->ContentBuildId);
+			return;
+		}
+
+		if (!WriteStringAsUtf8TextFile(ListingText, ListingFullPath))
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Failed to write content listing to '%s'"), *ListingFullPath);
+		}
+		SharedThis->ApplyContentListing(ListingText);
+	});
+	ContentListingRequest->ProcessRequest();
+}
+
+void FChunkDownloaderCustom::ApplyContentListing(const FString& ListingText)
+{
+	// chunk id, tab, package name. Properties start with $
+	TMap<int32, TArray<FName>> ListedPackages;
+	UE::String::ParseLines(ListingText, [&ListedPackages](FStringView Line)
+	{
+		int32 TabIndex = INDEX_NONE;
+		if (Line.StartsWith(TEXT('$')) || !Line.FindChar(TEXT('\t'), TabIndex))
+		{
+			return;
+		}
+		const int32 ChunkId = FCString::Atoi(Line.GetData());
+		const FStringView PackageName = Line.RightChop(TabIndex + 1);
+		ListedPackages.FindOrAdd(ChunkId).Emplace(PackageName.Len(), PackageName.GetData());
+	});
+
+	// mounted chunks were indexed from their actual content already
+	int32 NumPackages = 0;
+	for (auto& It : ListedPackages)
+	{
+		TSharedRef<FChunk>* Chunk = Chunks.Find(It.Key);
+		if (Chunk != nullptr && !(*Chunk)->bIsMounted)
+		{
+			NumPackages += It.Value.Num();
+			IndexChunkPackages(**Chunk, MoveTemp(It.Value));
+		}
+	}
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Content listing loaded, %d packages in %d chunks (%d packages indexed overall)."), NumPackages, ListedPackages.Num(), PackageChunks.Num());
+}
+
+void FChunkDownloaderCustom::IndexChunkPackages(FChunk& Chunk, TArray<FName>&& Packages)
+{
+	UnindexChunkPackages(Chunk);
+	Chunk.IndexedPackages = MoveTemp(Packages);
+	for (const FName& PackageName : Chunk.IndexedPackages)
+	{
+		PackageChunks.FindOrAdd(PackageName).AddUnique(Chunk.ChunkId);
+	}
+}
+
+void FChunkDownloaderCustom::UnindexChunkPackages(FChunk& Chunk)
+{
+	for (const FName& PackageName : Chunk.IndexedPackages)
+	{
+		TArray<int32, TInlineAllocator<1>>* ChunkIds = PackageChunks.Find(PackageName);
+		if (ChunkIds != nullptr && ChunkIds->RemoveSingleSwap(Chunk.ChunkId) > 0 && ChunkIds->Num() <= 0)
+		{
+			PackageChunks.Remove(PackageName);
+		}
+	}
+	Chunk.IndexedPackages.Empty();
+}
+
+bool FChunkDownloaderCustom::GetChunksForPackage(FName PackageName, TArray<int32>& OutChunkIds) const
+{
+	OutChunkIds.Reset();
+	const TArray<int32, TInlineAllocator<1>>* ChunkIds = PackageChunks.Find(PackageName);
+	if (ChunkIds == nullptr)
+	{
+		return false;
+	}
+	OutChunkIds.Append(*ChunkIds);
+	return true;
+}
+
+void FChunkDownloaderCustom::LoadChunkTransitions()
+{
+	// from chunk, tab, to chunk, tab, count. Properties start with $
+	FString TransitionsText;
+	if (!FFileHelper::LoadFileToString(TransitionsText, *(CacheFolder / CHUNK_TRANSITIONS)))
+	{
+		return;
+	}
+
+	ChunkTransitions.Empty();
+	UE::String::ParseLines(TransitionsText, [this](FStringView Line)
+	{
+		TArray<FString> Fields;
+		if (Line.StartsWith(TEXT('$')) || FString(Line).ParseIntoArray(Fields, TEXT("\t")) != 3)
+		{
+			return;
+		}
+		const int32 Count = FCString::Atoi(*Fields[2]);
+		if (Count > 0)
+		{
+			ChunkTransitions.FindOrAdd(FCString::Atoi(*Fields[0])).Add(FCString::Atoi(*Fields[1]), Count);
+		}
+	});
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Loaded chunk access history for %d chunks."), ChunkTransitions.Num());
+}
+
+void FChunkDownloaderCustom::SaveChunkTransitions(bool bForce)
+{
+	if (bForce)
+	{
+		bTransitionSaveDeferred = false;
+		WriteChunkTransitions(true);
+		return;
+	}
+
+	// every request can record an access, it only needs the last write
+	if (!bTransitionSaveDeferred && bNeedsTransitionSave)
+	{
+		bTransitionSaveDeferred = true;
+		TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+		DeferWork(TEXT("Chunk transitions save"), [WeakThisPtr]() {
+			TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+			if (SharedThis.IsValid() && SharedThis->bTransitionSaveDeferred)
+			{
+				SharedThis->bTransitionSaveDeferred = false;
+				SharedThis->WriteChunkTransitions(false);
+			}
+		});
+	}
+}
+
+void FChunkDownloaderCustom::WriteChunkTransitions(bool bForce)
+{
+	if (bForce || bNeedsTransitionSave)
+	{
+		int32 NumEntries = 0;
+		for (const auto& It : ChunkTransitions)
+		{
+			NumEntries += It.Value.Num();
+		}
+
+		FString TransitionsText = FString::Printf(TEXT("$NUM_ENTRIES = %d\n"), NumEntries);
+		for (const auto& It : ChunkTransitions)
+		{
+			for (const auto& Next : It.Value)
+			{
+				TransitionsText += FString::Printf(TEXT("%d\t%d\t%d\n"), It.Key, Next.Key, Next.Value);
+			}
+		}
+
+		if (WriteStringAsUtf8TextFile(TransitionsText, CacheFolder / CHUNK_TRANSITIONS))
+		{
+			bNeedsTransitionSave = false;
+		}
+	}
+}
+
+void FChunkDownloaderCustom::RecordChunkAccess(TConstArrayView<int32> ChunkIds)
+{
+	// this is what the prefetch was for
+	for (int32 ChunkId : ChunkIds)
+	{
+		uint64 PrefetchedBytes = 0;
+		if (PrefetchedChunks.RemoveAndCopyValue(ChunkId, PrefetchedBytes))
+		{
+			++PrefetchStats.NumHits;
+			PrefetchStats.BytesHit += PrefetchedBytes;
+		}
+	}
+
+	// the chunks of one request are a single step, they don't lead to each other. Only chunks that are new since the last request count.
+	bool bAnyNewChunk = false;
+	for (int32 ChunkId : ChunkIds)
+	{
+		if (LastAccessedChunks.Contains(ChunkId))
+		{
+			continue;
+		}
+		bAnyNewChunk = true;
+
+		for (int32 FromChunkId : LastAccessedChunks)
+		{
+			// halve the counts once in a while so recent habits win over old ones
+			static const int32 MAX_TRANSITION_COUNT = 256;
+			TMap<int32, int32>& Transitions = ChunkTransitions.FindOrAdd(FromChunkId);
+			if (++Transitions.FindOrAdd(ChunkId) >= MAX_TRANSITION_COUNT)
+			{
+				for (auto It = Transitions.CreateIterator(); It; ++It)
+				{
+					It.Value() /= 2;
+					if (It.Value() <= 0)
+					{
+						It.RemoveCurrent();
+					}
+				}
+			}
+			bNeedsTransitionSave = true;
+		}
+	}
+	if (!bAnyNewChunk)
+	{
+		return;
+	}
+	LastAccessedChunks.Reset();
+	LastAccessedChunks.Append(ChunkIds.GetData(), ChunkIds.Num());
+	SaveChunkTransitions(false);
+
+	if (bPrefetchPredictor)
+	{
+		for (int32 ChunkId : ChunkIds)
+		{
+			PrefetchLikelyChunks(ChunkId);
+		}
+	}
+}
+
+void FChunkDownloaderCustom::PrefetchLikelyChunks(int32 ChunkId)
+{
+	// never compete with a loading screen
+	const TMap<int32, int32>* Transitions = ChunkTransitions.Find(ChunkId);
+	if (Transitions == nullptr || BuildBaseUrls.Num() <= 0 || PostLoadCallbacks.Num() > 0)
+	{
+		return;
+	}
+
+	int32 TotalCount = 0;
+	TArray<TPair<int32, int32>> Candidates;
+	for (const auto& It : *Transitions)
+	{
+		TotalCount += It.Value;
+		Candidates.Emplace(It.Key, It.Value);
+	}
+	Candidates.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B) { return A.Value > B.Value; });
+
+	// what was prefetched and not used yet counts against the disk budget
+	uint64 BytesPending = 0;
+	for (const auto& It : PrefetchedChunks)
+	{
+		BytesPending += It.Value;
+	}
+
+	int32 NumPrefetched = 0;
+	for (const TPair<int32, int32>& Candidate : Candidates)
+	{
+		const float Probability = (float)Candidate.Value / (float)TotalCount;
+		if (NumPrefetched >= PrefetchMaxChunks || Probability < PrefetchMinProbability)
+		{
+			break;
+		}
+
+		const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(Candidate.Key);
+		if (ChunkPtr == nullptr || (*ChunkPtr)->PakFiles.Num() <= 0 || (*ChunkPtr)->bIsMounted || PrefetchedChunks.Contains(Candidate.Key))
+		{
+			continue;
+		}
+		const FChunk& Chunk = **ChunkPtr;
+
+		uint64 BytesMissing = 0;
+		for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+		{
+			if (!PakFile->bIsCached)
+			{
+				BytesMissing += PakFile->Entry.FileSize - FMath::Min(PakFile->SizeOnDisk, PakFile->Entry.FileSize);
+			}
+		}
+		if (BytesMissing <= 0 || BytesPending + BytesMissing > (uint64)PrefetchBudgetBytes)
+		{
+			continue;
+		}
+
+		// lowest priority in a class with a small share of the slots, so what's requested for real goes first
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Prefetching chunk %d (%.0f%% likely after chunk %d, %llu bytes)."), Chunk.ChunkId, Probability * 100.0f, ChunkId, BytesMissing);
+		DownloadChunkInternal(Chunk, FCallback(), MIN_int32, PREFETCH_DOWNLOAD_CLASS);
+		PrefetchedChunks.Add(Chunk.ChunkId, BytesMissing);
+		BytesPending += BytesMissing;
+		++PrefetchStats.NumPrefetches;
+		PrefetchStats.BytesPrefetched += BytesMissing;
+		++NumPrefetched;
+	}
+}
+
+void FChunkDownloaderCustom::CheckPrefetchedChunks()
+{
+	// prefetched chunks that aren't on their way to disk anymore were a waste
+	for (auto It = PrefetchedChunks.CreateIterator(); It; ++It)
+	{
+		const EChunkStatus Status = GetChunkStatus(It.Key());
+		if (Status != EChunkStatus::Cached && Status != EChunkStatus::Downloading && Status != EChunkStatus::Mounted)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Prefetched chunk %d was dropped before being used (%llu bytes wasted)."), It.Key(), It.Value());
+			PrefetchStats.BytesWasted += It.Value();
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FChunkDownloaderCustom::PausePrefetches()
+{
+	// prefetches still on their way aren't counted as wasted, they're predicted (and resume where they left off) again later
+	for (auto It = PrefetchedChunks.CreateIterator(); It; ++It)
+	{
+		if (GetChunkStatus(It.Key()) == EChunkStatus::Downloading)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// drop the paks nobody but a prefetch is waiting on, like PauseBackgroundInstall
+	TArray<TSharedRef<FPakFileRecord>> PrefetchRequests = DownloadRequests.FilterByPredicate([](const TSharedRef<FPakFileRecord>& PakFile) {
+		return PakFile->Priority == MIN_int32 && PakFile->DownloadClass == PREFETCH_DOWNLOAD_CLASS;
+	});
+	if (PrefetchRequests.Num() > 0)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Pausing %d prefetch downloads for loading mode."), PrefetchRequests.Num());
+	}
+	for (const TSharedRef<FPakFileRecord>& PakFile : PrefetchRequests)
+	{
+		if (PakFile->Download.IsValid())
+		{
+			CancelDownload(PakFile, false);
+			continue;
+		}
+
+		DownloadRequests.RemoveSingle(PakFile);
+		DownloadRequestBytesRemaining -= PakFile->Entry.FileSize;
+		PakFile->DownloadClass = NAME_None;
+		for (const FCallback& Callback : PakFile->PostDownloadCallbacks)
+		{
+			ExecuteNextTick(Callback, false);
+		}
+		PakFile->PostDownloadCallbacks.Empty();
+		InvalidateChunkStatus(*PakFile);
+	}
+}
+
+void FChunkDownloaderCustom::ResolveChunkClosure(FName PackageName, const FChunkClosureCallback& Callback)
+{
+	TArray<int32> RootChunkIds;
+	if (!GetChunksForPackage(PackageName, RootChunkIds))
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Can't resolve the chunks needed by package %s (not in any known chunk)."), *PackageName.ToString());
+		if (Callback)
+		{
+			DeferWork(TEXT("Closure callback"), [Callback]() {
+				Callback(false, TArray<int32>());
+			});
+		}
+		return;
+	}
+
+	TSharedRef<FChunkClosure> Closure = MakeShared<FChunkClosure>();
+	Closure->RootPackage = PackageName;
+	Closure->Frontier.Add(PackageName);
+	Closure->VisitedPackages.Add(PackageName);
+	Closure->Callback = Callback;
+	ContinueChunkClosure(Closure);
+}
+
+void FChunkDownloaderCustom::ContinueChunkClosure(const TSharedRef<FChunkClosure>& Closure)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	const UE::AssetRegistry::FDependencyQuery HardDependencies(UE::AssetRegistry::EDependencyQuery::Hard);
+
+	// packages waiting on fragments are walked again now
+	Closure->Frontier.Append(MoveTemp(Closure->Deferred));
+	Closure->Deferred.Reset();
+
+	TArray<TSharedRef<FPakFileRecord>> MissingFragments;
+	TArray<int32> PackageChunkIds;
+	TArray<FAssetIdentifier> Dependencies;
+	while (Closure->Frontier.Num() > 0)
+	{
+		const FName PackageName = Closure->Frontier.Pop(false);
+
+		// anything that isn't in a chunk ships with the game, along with its dependencies
+		if (!GetChunksForPackage(PackageName, PackageChunkIds))
+		{
+			continue;
+		}
+		Closure->ChunkIds.Append(PackageChunkIds);
+
+		// get the dependencies recorded in the fragments of the chunks containing it
+		bool bWaitingOnFragment = false;
+		Dependencies.Reset();
+		for (int32 ChunkId : PackageChunkIds)
+		{
+			TSharedPtr<FAssetRegistryState>* State = Closure->Fragments.Find(ChunkId);
+			if (State == nullptr)
+			{
+				const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+				const TSharedRef<FPakFileRecord>* Fragment = (ChunkPtr == nullptr) ? nullptr : (*ChunkPtr)->PakFiles.FindByPredicate([](const TSharedRef<FPakFileRecord>& PakFile) {
+					return PakFile->IsAssetRegistryFragment();
+				});
+
+				// fetch it first (if there's anywhere to fetch it from)
+				const bool bFragmentOnDisk = (Fragment != nullptr) && ((*Fragment)->bIsCached || (*Fragment)->bIsEmbedded);
+				if (Fragment != nullptr && !bFragmentOnDisk && BuildBaseUrls.Num() > 0)
+				{
+					MissingFragments.AddUnique(*Fragment);
+					bWaitingOnFragment = true;
+					continue;
+				}
+
+				TSharedPtr<FAssetRegistryState> LoadedState;
+				if (bFragmentOnDisk)
+				{
+					FString FullPathOnDisk = ((*Fragment)->bIsEmbedded ? EmbeddedFolder : CacheFolder) / (*Fragment)->Entry.FileName;
+					LoadedState = MakeShared<FAssetRegistryState>();
+					if (!FAssetRegistryState::LoadFromDisk(*FullPathOnDisk, FAssetRegistryLoadOptions(), *LoadedState))
+					{
+						UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Unable to load asset registry fragment '%s' for chunk %d, its dependencies will be missing."), *FullPathOnDisk, ChunkId);
+						LoadedState.Reset();
+					}
+				}
+				State = &Closure->Fragments.Add(ChunkId, LoadedState);
+			}
+			if (State->IsValid())
+			{
+				(*State)->GetDependencies(FAssetIdentifier(PackageName), Dependencies, UE::AssetRegistry::EDependencyCategory::Package, HardDependencies);
+			}
+		}
+		if (bWaitingOnFragment)
+		{
+			Closure->Deferred.Add(PackageName);
+			continue;
+		}
+
+		// and whatever the asset registry knows about (e.g. chunks that were mounted and scanned)
+		AssetRegistry.GetDependencies(FAssetIdentifier(PackageName), Dependencies, UE::AssetRegistry::EDependencyCategory::Package, HardDependencies);
+		for (const FAssetIdentifier& Dependency : Dependencies)
+		{
+			if (!Dependency.PackageName.IsNone() && !FPackageName::IsScriptPackage(Dependency.PackageName.ToString()) && !Closure->VisitedPackages.Contains(Dependency.PackageName))
+			{
+				Closure->VisitedPackages.Add(Dependency.PackageName);
+				Closure->Frontier.Add(Dependency.PackageName);
+			}
+		}
+	}
+
+	// download missing fragments (without mounting anything) and carry on
+	if (MissingFragments.Num() > 0)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Downloading %d asset registry fragments to resolve the chunks needed by %s."), MissingFragments.Num(), *Closure->RootPackage.ToString());
+		TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+		FMultiCallback* MultiCallback = new FMultiCallback([WeakThisPtr, Closure, MissingFragments](bool) {
+			TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+			if (!SharedThis.IsValid())
+			{
+				return;
+			}
+
+			// don't wait on fragments that failed to download again
+			for (const TSharedRef<FPakFileRecord>& Fragment : MissingFragments)
+			{
+				if (!Fragment->bIsCached)
+				{
+					Closure->Fragments.Add(Fragment->Entry.ChunkId, nullptr);
+				}
+			}
+			SharedThis->ContinueChunkClosure(Closure);
+		});
+		for (const TSharedRef<FPakFileRecord>& Fragment : MissingFragments)
+		{
+			DownloadPakFileInternal(Fragment, MultiCallback->AddPending(), MAX_int32);
+		}
+		return;
+	}
+
+	TArray<int32> ChunkIds = Closure->ChunkIds.Array();
+	ChunkIds.Sort();
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Package %s needs %d chunks (%d packages walked)."), *Closure->RootPackage.ToString(), ChunkIds.Num(), Closure->VisitedPackages.Num());
+	if (Closure->Callback)
+	{
+		DeferWork(TEXT("Closure callback"), [Callback = Closure->Callback, ChunkIds]() {
+			Callback(true, ChunkIds);
+		});
+	}
+}
+
+void FChunkDownloaderCustom::AcquirePackage(FName PackageName, const FCallback& Callback, bool bPreScanAssets)
+{
+	++PackageAcquireStats.NumRequests;
+
+	// join an acquisition already in flight
+	if (TSharedRef<FPackageAcquisition>* Existing = PackageAcquisitions.Find(PackageName))
+	{
+		++PackageAcquireStats.NumJoined;
+		if (Callback)
+		{
+			(*Existing)->Callbacks.Add(Callback);
+		}
+		return;
+	}
+
+	// find out which chunks we need
+	TArray<int32> ChunkIds;
+	if (!GetChunksForPackage(PackageName, ChunkIds))
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Can't acquire package %s (not in any known chunk)."), *PackageName.ToString());
+		++PackageAcquireStats.NumFailed;
+		ExecuteNextTick(Callback, false);
+		return;
+	}
+
+	// only the ones that aren't mounted (or are being unmounted)
+	TArray<FChunk*> ChunksToMount;
+	for (int32 ChunkId : ChunkIds)
+	{
+		TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+		if (ChunkPtr != nullptr && (*ChunkPtr)->PakFiles.Num() > 0 && (!(*ChunkPtr)->bIsMounted || (*ChunkPtr)->MountTask != nullptr))
+		{
+			ChunksToMount.Add(&ChunkPtr->Get());
+		}
+	}
+	if (ChunksToMount.Num() <= 0)
+	{
+		// trivial success
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Acquiring package %s (%d chunks to mount)."), *PackageName.ToString(), ChunksToMount.Num());
+	++PackageAcquireStats.NumMisses;
+	TSharedRef<FPackageAcquisition> Acquisition = MakeShared<FPackageAcquisition>();
+	Acquisition->StartTime = FPlatformTime::Seconds();
+	if (Callback)
+	{
+		Acquisition->Callbacks.Add(Callback);
+	}
+	PackageAcquisitions.Add(PackageName, Acquisition);
+
+	// mounts download whatever they're missing with top priority
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	FMultiCallback* MultiCallback = new FMultiCallback([WeakThisPtr, PackageName](bool bSuccess) {
+		TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+		if (SharedThis.IsValid())
+		{
+			SharedThis->CompletePackageAcquisition(PackageName, bSuccess);
+		}
+	});
+	TArray<int32> AccessedChunkIds;
+	for (FChunk* Chunk : ChunksToMount)
+	{
+		AccessedChunkIds.Add(Chunk->ChunkId);
+		MountChunkInternal(*Chunk, bPreScanAssets, MultiCallback->AddPending());
+	}
+	RecordChunkAccess(AccessedChunkIds);
+
+	// resave manifest if needed
+	SaveLocalManifest(false);
+	ComputeLoadingStats();
+}
+
+void FChunkDownloaderCustom::CompletePackageAcquisition(FName PackageName, bool bSuccess)
+{
+	// may have been flushed by Finalize
+	TSharedRef<FPackageAcquisition>* AcquisitionPtr = PackageAcquisitions.Find(PackageName);
+	if (AcquisitionPtr == nullptr)
+	{
+		return;
+	}
+	TSharedRef<FPackageAcquisition> Acquisition = *AcquisitionPtr;
+	PackageAcquisitions.Remove(PackageName);
+
+	const double MissSeconds = FPlatformTime::Seconds() - Acquisition->StartTime;
+	PackageAcquireStats.TotalMissSeconds += MissSeconds;
+	PackageAcquireStats.MaxMissSeconds = FMath::Max(PackageAcquireStats.MaxMissSeconds, MissSeconds);
+	if (bSuccess)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Package %s acquired in %.1f ms (%d waiting)."), *PackageName.ToString(), MissSeconds * 1000.0, Acquisition->Callbacks.Num());
+	}
+	else
+	{
+		++PackageAcquireStats.NumFailed;
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Failed to acquire package %s after %.1f ms."), *PackageName.ToString(), MissSeconds * 1000.0);
+	}
+
+	for (const FCallback& Callback : Acquisition->Callbacks)
+	{
+		Callback(bSuccess);
+	}
+}
+
+void FChunkDownloaderCustom::LoadManifest(const TArray<FPakManifestEntry>& ManifestPakFiles)
+{
+
+
+
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Beginning manifest load."));
+
+	// wait for all mounts to finish
+	WaitForMounts();
+
+	// trigger garbage collection (give any unmounts which are about to happen a good chance of success)
+	CollectGarbage(RF_NoFlags);
+
+	// group the manifest paks by chunk ID (maintain ordering)
+	TMap<int32,TArray<FPakManifestEntry>> Manifest;
+	for (const FPakManifestEntry& FileEntry : ManifestPakFiles)
+	{
+		check(FileEntry.ChunkId >= 0);
+		Manifest.FindOrAdd(FileEntry.ChunkId).Add(FileEntry);
+	}
+
+	// copy old chunk map (we will reuse any that still exist)
+	TMap<int32,TSharedRef<FChunk>> OldChunks = MoveTemp(Chunks);
+	TMap<FString,TSharedRef<FPakFileRecord>> OldPakFiles = MoveTemp(PakFiles);
+
+	// loop over the new chunks
+	int32 NumChunks = 0, NumPaks = 0;
+	for (const auto& It : Manifest)
+	{
+		int32 ChunkId = It.Key;
+		
+		// keep track of new chunk and old pak files
+		TSharedPtr<FChunk> Chunk;
+		TArray<TSharedRef<FPakFileRecord>> PrevPakList;
+
+		// create or reuse the chunk
+		TSharedRef<FChunk>* OldChunk = OldChunks.Find(ChunkId);
+		if (OldChunk != nullptr)
+		{
+			// move over the old chunk
+			Chunk = *OldChunk;
+			check(Chunk->ChunkId == ChunkId);
+
+			// don't clean it up later
+			OldChunks.Remove(ChunkId);
+
+			// move out OldPakFiles
+			PrevPakList = MoveTemp(Chunk->PakFiles);
+		}
+		else
+		{
+			// make a brand new chunk
+			Chunk = MakeShared<FChunk>();
+			Chunk->ChunkId = ChunkId;
+		}
+
+		// add the chunk to the new map (its pak files are about to change)
+		Chunks.Add(Chunk->ChunkId, Chunk.ToSharedRef());
+		Chunk->bStatusDirty = true;
+
+		// find or create new pak files
+		check(Chunk->PakFiles.Num() == 0);
+		for (const FPakManifestEntry& FileEntry : It.Value)
+		{
+			// see if there's an existing file for this one
+			const TSharedRef<FPakFileRecord>* ExistingFilePtr = OldPakFiles.Find(FileEntry.FileName);
+			if (ExistingFilePtr != nullptr)
+			{
+				const TSharedRef<FPakFileRecord>& ExistingFile = *ExistingFilePtr;
+				if (ExistingFile->Entry.FileVersion == FileEntry.FileVersion)
+				{
+					// if version matched, size should too
+					check(ExistingFile->Entry.FileSize == FileEntry.FileSize);
+
+					// update and add to list (may populate ChunkId and RelativeUrl if we loaded from cache)
+					ExistingFile->Entry = FileEntry;
+					Chunk->PakFiles.Add(ExistingFile);
+					PakFiles.Add(ExistingFile->Entry.FileName, ExistingFile);
+
+					// remove from old pak files list
+					OldPakFiles.Remove(FileEntry.FileName);
+					continue;
+				}
+			}
+
+			// create a new entry
+			TSharedRef<FPakFileRecord> NewFile = MakeShared<FPakFileRecord>();
+			NewFile->Entry = FileEntry;
+			Chunk->PakFiles.Add(NewFile);
+			PakFiles.Add(NewFile->Entry.FileName, NewFile);
+
+			// see if it matches an embedded pak file
+			const FPakManifestEntry* CachedEntry = EmbeddedPaks.Find(FileEntry.FileName);
+			if (CachedEntry != nullptr && CachedEntry->FileVersion == FileEntry.FileVersion)
+			{
+				NewFile->bIsEmbedded = true;
+				NewFile->bIsCached = true;
+				NewFile->SizeOnDisk = CachedEntry->FileSize;
+			}
+		}
+
+		// log the chunk and pak file count
+		UE_LOG(LogChunkDownloaderCustom, Verbose, TEXT("Found chunk %d (%d pak files)."), ChunkId, Chunk->PakFiles.Num());
+		++NumChunks;
+		NumPaks += Chunk->PakFiles.Num();
+
+		// whatever we knew about the content of a chunk whose pak files changed is stale
+		bool bPakFilesChanged = PrevPakList.Num() != Chunk->PakFiles.Num();
+		for (int32 i = 0; i < PrevPakList.Num() && !bPakFilesChanged; ++i)
+		{
+			bPakFilesChanged = Chunk->PakFiles[i]->Entry.FileVersion != PrevPakList[i]->Entry.FileVersion;
+		}
+		if (bPakFilesChanged)
+		{
+			UnindexChunkPackages(*Chunk);
+		}
+
+		// if the chunk is already mounted, we want to unmount any invalid data
+		check(Chunk->MountTask == nullptr); // we already waited for mounts to finish
+		if (Chunk->bIsMounted)
+		{
+			// see if all the existing pak files match to the new manifest (means it can stay mounted)
+			// this is a common case so we're trying to be more efficient here
+			int LongestCommonPrefix = 0;
+			for (int i=0;i < PrevPakList.Num() && i < Chunk->PakFiles.Num();++i,++LongestCommonPrefix)
+			{
+				if (Chunk->PakFiles[i]->Entry.FileVersion != PrevPakList[i]->Entry.FileVersion)
+				{
+					break;
+				}
+			}
+
+			// if they don't all match we need to remount
+			if (LongestCommonPrefix != PrevPakList.Num() || LongestCommonPrefix != Chunk->PakFiles.Num())
+			{
+				// this chunk is no longer fully mounted
+				Chunk->bIsMounted = false;
+
+				// unmount any old paks that didn't match (reverse order)
+				for (int i= PrevPakList.Num()-1;i>=0;--i)
+				{
+					UnmountPakFile(PrevPakList[i]);
+				}
+
+				// unmount any new paks that didn't match (may have changed position) (reverse order)
+				// any new pak files unmounted will be re-mounted (in the right order) if this chunk is requested again
+				for (int i=Chunk->PakFiles.Num()-1;i>=0;--i)
+				{
+					UnmountPakFile(Chunk->PakFiles[i]);
+				}
+			}
+		}
+	}
+
+	// chunks still left in OldChunks are gone from the build
+	for (const auto& It : OldChunks)
+	{
+		UnindexChunkPackages(*It.Value);
+	}
+
+	// any files still left in OldPakFiles should be cancelled, unmounted, and deleted
+	for (const auto& It : OldPakFiles)
+	{
+		const TSharedRef<FPakFileRecord>& File = It.Value;
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Removing orphaned pak file %s (was chunk %d)."), *File->Entry.FileName, File->Entry.ChunkId);
+
+		// cancel downloads of pak files that are no longer valid
+		if (File->Download.IsValid())
+		{
+			// treat these cancellations as successful since the pak is no longer needed (we've successfully downloaded nothing)
+			CancelDownload(File, true);
+		}
+
+		// if a chunk completely disappeared we may need to clean up its mounts this way (otherwise would have been taken care of above)
+		if (File->bIsMounted)
+		{
+			UnmountPakFile(File);
+		}
+
+		// delete any locally cached file (a canceled transfer may still be writing one)
+		if ((File->SizeOnDisk > 0 || TransfersInFlight.Contains(File->Entry.FileName)) && !File->bIsEmbedded)
+		{
+			bNeedsManifestSave = true;
+			bNeedsVerifiedManifestSave = true;
+			FString FullPathOnDisk = CacheFolder / File->Entry.FileName;
+			if (!ensure(DeleteCachedFile(File->Entry.FileName)))
+			{
+				UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Failed to delete orphaned pak %s."), *FullPathOnDisk);
+			}
+		}
+	}
+
+	// resave the manifest
+	SaveLocalManifest(false);
+	CheckPrefetchedChunks();
+
+	// chunks the background install gave up on may download fine from the new build
+	BackgroundInstallSkipped.Empty();
+
+	// log end
+	check(ManifestPakFiles.Num() == NumPaks);
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Manifest load complete. %d chunks with %d pak files."), NumChunks, NumPaks);
+}
+
+void FChunkDownloaderCustom::DownloadChunkInternal(const FChunk& Chunk, const FCallback& Callback, int32 Priority, FName DownloadClass)
+{
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d download requested."), Chunk.ChunkId);
+
+	// see if we need to download anything at all
+	bool bNeedsDownload = false;
+	for (const auto& PakFile : Chunk.PakFiles)
+	{
+		if (!PakFile->bIsCached)
+		{
+			bNeedsDownload = true;
+			break;
+		}
+	}
+	if (!bNeedsDownload)
+	{
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	// make sure we have CDN configured
+	if (BuildBaseUrls.Num() <= 0)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to download Chunk %d (no CDN urls)."), Chunk.ChunkId);
+		ExecuteNextTick(Callback, false);
+		return;
+	}
+
+	// download all pak files that aren't already cached
+	FMultiCallback* MultiCallback = new FMultiCallback(Callback);
+	for (const auto& PakFile : Chunk.PakFiles)
+	{
+		if (!PakFile->bIsCached)
+		{
+			DownloadPakFileInternal(PakFile, MultiCallback->AddPending(), Priority, DownloadClass);
+		}
+	}
+	check(MultiCallback->GetNumPending() > 0);
+} //-V773
+
+void FChunkDownloaderCustom::MountChunkInternal(FChunk& Chunk, bool bPreScanAssets, const FCallback& Callback)
+{
+	// a mounted chunk can only get here while it's being unmounted
+	check(!Chunk.bIsMounted || Chunk.MountTask != nullptr);
+
+	// see if there's already a mount or unmount pending
+	if (Chunk.MountTask != nullptr)
+	{
+		if (!Chunk.MountTask->GetTask().bIsUnmountTask)
+		{
+			// mount, unmount, mount is just a mount
+			DiscardQueuedChunkOp(Chunk);
+
+			// Flag for Asset Registry scan if necessary. Never set it to false here since at least one call already expects the scan to be done.
+			if (bPreScanAssets)
+			{
+				Chunk.MountTask->GetTask().bPreScanAssets = true;
+			}
+
+			// join with the existing callbacks
+			if (Callback)
+			{
+				Chunk.MountTask->GetTask().PostMountCallbacks.Add(Callback);
+			}
+			return;
+		}
+
+		// there is an unmount pending. If it's still waiting for a worker we can just drop it, otherwise mount right after it.
+		if (!TryCancelMountTask(Chunk))
+		{
+			QueueChunkOp(Chunk, EChunkMountOp::Mount, bPreScanAssets, Callback);
+			return;
+		}
+
+		// nothing was unmounted yet
+		if (Chunk.bIsMounted)
+		{
+			ExecuteNextTick(Callback, true);
+			return;
+		}
+	}
+
+	// see if we need to trigger any downloads
+	bool bAllPaksCached = true;
+	for (const auto& PakFile : Chunk.PakFiles)
+	{
+		if (!PakFile->bIsCached)
+		{
+			bAllPaksCached = false;
+			break;
+		}
+	}
+
+	// make sure files we only know by their size are intact before mounting them (e.g. if we crashed while writing them)
+	if (bAllPaksCached)
+	{
+		TArray<TSharedRef<FPakFileRecord>> UnverifiedPakFiles;
+		for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+		{
+			// known to be invalid and stuck in the cache (see EvictPakFile)
+			if (PakFile->VerifyStatus == EVerifyStatus::Failed)
+			{
+				UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to mount chunk %d, %s failed verification and couldn't be deleted."), Chunk.ChunkId, *PakFile->Entry.FileName);
+				LoadingModeStats.LastError = FText::Format(LOCTEXT("FailedToMount", "Failed to mount {0}."), FText::FromString(PakFile->Entry.FileName));
+				ExecuteNextTick(Callback, false);
+				return;
+			}
+			if (!PakFile->bIsMounted && !IsPakFileVerified(*PakFile))
+			{
+				UnverifiedPakFiles.Add(PakFile);
+			}
+		}
+
+		// with lazy verification, they'll be sampled by the mount task instead
+		if (UnverifiedPakFiles.Num() > 0 && !bLazyMountVerification)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d mount requested, verifying %d pak files first."), Chunk.ChunkId, UnverifiedPakFiles.Num());
+
+			TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+			int32 ChunkId = Chunk.ChunkId;
+			uint32 UnmountSerial = Chunk.UnmountSerial;
+			FMultiCallback* MultiCallback = new FMultiCallback([WeakThisPtr, ChunkId, UnmountSerial, bPreScanAssets, Callback](bool) {
+				// no need to check for success, invalid files were evicted and mounting again will download them
+				TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+				if (SharedThis.IsValid() && !SharedThis->IsMountSuperseded(ChunkId, UnmountSerial))
+				{
+					SharedThis->MountChunkById(ChunkId, Callback, bPreScanAssets);
+					return;
+				}
+
+				// if anything went wrong, fire the callback now
+				if (Callback)
+				{
+					Callback(false);
+				}
+			});
+			for (const TSharedRef<FPakFileRecord>& PakFile : UnverifiedPakFiles)
+			{
+				VerifyPakFileInternal(PakFile, MultiCallback->AddPending(), EQueuedWorkPriority::High);
+			}
+			check(MultiCallback->GetNumPending() > 0);
+			return;
+		} //-V773
+	}
+
+	if (bAllPaksCached)
+	{
+		// if all pak files are cached, mount now
+		CreateMountTask(Chunk, bPreScanAssets, Callback);
+	}
+	else
+	{
+		// queue up pak file downloads
+		TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+		int32 ChunkId = Chunk.ChunkId;
+		uint32 UnmountSerial = Chunk.UnmountSerial;
+		DownloadChunkInternal(Chunk, [WeakThisPtr, ChunkId, UnmountSerial, bPreScanAssets, Callback](bool bDownloadSuccess) {
+			// if the download failed, we can't mount
+			if (bDownloadSuccess)
+			{
+				TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+				if (SharedThis.IsValid() && !SharedThis->IsMountSuperseded(ChunkId, UnmountSerial))
+				{
+					// if all chunks are downloaded, do the mount again (this will pick up any changes and continue downloading if needed)
+					SharedThis->MountChunkById(ChunkId, Callback, bPreScanAssets);
+					return;
+				}
+			}
+
+			// if anything went wrong, fire the callback now
+			if (Callback)
+			{
+				Callback(false);
+			}
+		}, MAX_int32);
+	}
+}
+
+void FChunkDownloaderCustom::UnmountChunkInternal(FChunk& Chunk, const FCallback& Callback)
+{
+	// We should be allowed to trigger this since an unmounted chunk may have some mounted paks.
+	// check(!Chunk.bIsMounted);
+
+	// see if there's already a mount or unmount pending
+	if (Chunk.MountTask != nullptr)
+	{
+		if (Chunk.MountTask->GetTask().bIsUnmountTask)
+		{
+			// unmount, mount, unmount is just an unmount
+			DiscardQueuedChunkOp(Chunk);
+
+			// join with the existing callbacks
+			if (Callback)
+			{
+				Chunk.MountTask->GetTask().PostMountCallbacks.Add(Callback);
+			}
+			return;
+		}
+
+		// there is a mount pending. If it's still waiting for a worker we can just drop it, otherwise unmount right after it.
+		if (!TryCancelMountTask(Chunk))
+		{
+			QueueChunkOp(Chunk, EChunkMountOp::Unmount, false, Callback);
+			return;
+		}
+
+		// nothing was mounted by it, see if there's anything left to unmount
+		bool bAnyPaksMounted = false;
+		for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+		{
+			bAnyPaksMounted |= PakFile->bIsMounted;
+		}
+		if (!bAnyPaksMounted)
+		{
+			ExecuteNextTick(Callback, true);
+			return;
+		}
+	}
+
+	// No need to cache pak files, unmount now
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d unmount requested (%d pak sequence)."), Chunk.ChunkId, Chunk.PakFiles.Num());
+
+	// spin up a background task to unmount the pak file
+	check(Chunk.MountTask == nullptr);
+	Chunk.MountTask = new FMountTask();
+
+	// configure the task
+	FPakMountWork& MountWork = Chunk.MountTask->GetTask();
+	MountWork.ChunkId = Chunk.ChunkId;
+	MountWork.bIsUnmountTask = true;
+	MountWork.CacheFolder = CacheFolder;
+	MountWork.EmbeddedFolder = EmbeddedFolder;
+	for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+	{
+		if (PakFile->bIsMounted)
+		{
+			MountWork.PakFiles.Add(PakFile);
+		}
+	}
+	if (Callback)
+	{
+		MountWork.PostMountCallbacks.Add(Callback);
+	}
+
+	// start as a background task
+	StartMountTask(Chunk);
+}
+
+void FChunkDownloaderCustom::DownloadPakFileInternal(const TSharedRef<FPakFileRecord>& PakFile, const FCallback& Callback, int32 Priority, FName DownloadClass)
+{
+	check(BuildBaseUrls.Num() > 0);
+
+	// the class follows the first request, or a later one that's at least as urgent (a prefetch doesn't take over a real request)
+	const bool bIsQueued = DownloadRequests.Contains(PakFile);
+	if (!bIsQueued || Priority >= PakFile->Priority)
+	{
+		PakFile->DownloadClass = DownloadClass;
+	}
+
+	// increase priority if it's updated
+	if (Priority > PakFile->Priority)
+	{
+		// if the download has already started this won't really change anything
+		PakFile->Priority = Priority;
+	}
+
+	// just piggyback on the existing post-download callback
+	if (Callback)
+	{
+		PakFile->PostDownloadCallbacks.Add(Callback);
+	}
+
+	// see if the download is already started
+	if (PakFile->Download.IsValid())
+	{
+		// nothing to do then (we already added our callback)
+		return;
+	}
+
+	// add it to the downloading set
+	if (!bIsQueued)
+	{
+		DownloadRequests.Add(PakFile);
+		DownloadRequestBytesRemaining += PakFile->Entry.FileSize;
+	}
+	SortDownloadRequests();
+
+	// start the first N pak files in flight
+	IssueDownloads();
+
+	// measure bandwidth and watch deadlines until the queue drains
+	if (!DownloadScheduleTicker.IsValid())
+	{
+		BandwidthSampleBytes = TotalBytesReceived;
+		BandwidthSampleTime = FPlatformTime::Seconds();
+		DownloadScheduleTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FChunkDownloaderCustom::UpdateDownloadSchedule), 1.0f);
+	}
+}
+
+void FChunkDownloaderCustom::SetChunkDeadline(const FChunk& Chunk, const FDateTime& Deadline)
+{
+	// only ever move deadlines closer
+	bool bChanged = false;
+	for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+	{
+		if (!PakFile->bIsCached && Deadline < PakFile->Deadline)
+		{
+			PakFile->Deadline = Deadline;
+			PakFile->bDeadlineAtRisk = false;
+			bChanged = true;
+		}
+	}
+
+	// requests already queued need to move up
+	if (bChanged && DownloadRequests.Num() > 0)
+	{
+		SortDownloadRequests();
+		IssueDownloads();
+	}
+}
+
+void FChunkDownloaderCustom::SortDownloadRequests()
+{
+	// highest priority first, then earliest deadline first (no deadline goes last)
+	DownloadRequests.StableSort([](const TSharedRef<FPakFileRecord>& A, const TSharedRef<FPakFileRecord>& B) {
+		if (A->Priority != B->Priority)
+		{
+			return A->Priority > B->Priority;
+		}
+		return A->Deadline < B->Deadline;
+	});
+}
+
+bool FChunkDownloaderCustom::UpdateDownloadSchedule(float DeltaTime)
+{
+	// exponential moving average of the bytes received since the last sample, stalls (e.g. retries) included
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = Now - BandwidthSampleTime;
+	if (Elapsed > 0.0)
+	{
+		const double Sample = (double)(TotalBytesReceived - BandwidthSampleBytes) / Elapsed;
+		DownloadBandwidth = DownloadBandwidth > 0.0 ? FMath::Lerp(DownloadBandwidth, Sample, (double)DownloadBandwidthSmoothing) : Sample;
+		BandwidthSampleBytes = TotalBytesReceived;
+		BandwidthSampleTime = Now;
+	}
+
+	CheckDeadlines();
+
+	bool bDownloadsPending = DownloadRequests.Num() > 0;
+	if (!bDownloadsPending)
+	{
+		DownloadScheduleTicker.Reset();
+	}
+	return bDownloadsPending; // keep ticking
+}
+
+void FChunkDownloaderCustom::CheckDeadlines()
+{
+	// nothing to predict with yet
+	if (DownloadBandwidth <= 0.0)
+	{
+		return;
+	}
+
+	// requests with a deadline bypass the class sharing (see IssueDownloads): they wait on what's in flight, 
+	// then complete roughly in queue order with the other urgent requests, sharing the bandwidth
+	const FDateTime Now = FDateTime::UtcNow();
+	uint64 BytesAhead = 0;
+	for (const TSharedRef<FPakFileRecord>& PakFile : DownloadRequests)
+	{
+		if (PakFile->Download.IsValid())
+		{
+			const uint64 BytesReceived = (uint64)PakFile->Download->GetProgress();
+			BytesAhead += PakFile->Entry.FileSize - FMath::Min(BytesReceived, PakFile->Entry.FileSize);
+		}
+	}
+	for (const TSharedRef<FPakFileRecord>& PakFile : DownloadRequests)
+	{
+		if (!IsUrgentDownload(*PakFile))
+		{
+			continue;
+		}
+		if (!PakFile->Download.IsValid())
+		{
+			BytesAhead += PakFile->Entry.FileSize;
+		}
+		if (PakFile->Deadline == FDateTime::MaxValue() || PakFile->bDeadlineAtRisk)
+		{
+			continue;
+		}
+
+		const FDateTime PredictedCompletion = Now + FTimespan::FromSeconds(BytesAhead / DownloadBandwidth);
+		if (PredictedCompletion > PakFile->Deadline)
+		{
+			// warn once for the whole chunk
+			const int32 ChunkId = PakFile->Entry.ChunkId;
+			if (const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId))
+			{
+				for (const TSharedRef<FPakFileRecord>& ChunkPakFile : (*ChunkPtr)->PakFiles)
+				{
+					if (ChunkPakFile->Deadline == PakFile->Deadline)
+					{
+						ChunkPakFile->bDeadlineAtRisk = true;
+					}
+				}
+			}
+			PakFile->bDeadlineAtRisk = true;
+
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Chunk %d is predicted to miss its deadline by %.1f seconds (%llu bytes ahead at %.0f bytes/s)."),
+				ChunkId, (PredictedCompletion - PakFile->Deadline).GetTotalSeconds(), BytesAhead, DownloadBandwidth);
+			OnDeadlineAtRisk.Broadcast(ChunkId, PakFile->Deadline, PredictedCompletion);
+		}
+	}
+}
+
+float FChunkDownloaderCustom::GetDownloadClassWeight(FName DownloadClass) const
+{
+	const float* Weight = DownloadClassWeights.Find(DownloadClass);
+	return Weight != nullptr ? *Weight : 1.0f;
+}
+
+bool FChunkDownloaderCustom::IsUrgentDownload(const FPakFileRecord& PakFile)
+{
+	// needed right away (e.g. registry fragments for a closure) or by a given time
+	return PakFile.Priority == MAX_int32 || PakFile.Deadline != FDateTime::MaxValue();
+}
+
+void FChunkDownloaderCustom::IssueDownloads()
+{
+	// queue up the requests that aren't downloading yet by class, keeping their order (priority, then deadline).
+	// urgent ones (top priority or a deadline) don't take part in the sharing and go first
+	TArray<TSharedRef<FPakFileRecord>> UrgentQueue;
+	TMap<FName, TArray<TSharedRef<FPakFileRecord>>> ClassQueues;
+	TMap<FName, int32> ClassDownloadsInFlight;
+	int32 NumDownloadsInFlight = 0;
+	for (const TSharedRef<FPakFileRecord>& PakFile : DownloadRequests)
+	{
+		if (PakFile->Download.IsValid())
+		{
+			if (!IsUrgentDownload(*PakFile))
+			{
+				++ClassDownloadsInFlight.FindOrAdd(PakFile->DownloadClass);
+			}
+			++NumDownloadsInFlight;
+		}
+		else if (!TransfersInFlight.Contains(PakFile->Entry.FileName))
+		{
+			if (IsUrgentDownload(*PakFile))
+			{
+				UrgentQueue.Add(PakFile);
+			}
+			else
+			{
+				ClassQueues.FindOrAdd(PakFile->DownloadClass).Add(PakFile);
+			}
+		}
+	}
+
+	// start the urgent requests in queue order
+	int32 NumUrgentStarted = 0;
+	while (NumDownloadsInFlight < TargetDownloadsInFlight && NumUrgentStarted < UrgentQueue.Num())
+	{
+		StartDownload(UrgentQueue[NumUrgentStarted++]);
+		++NumDownloadsInFlight;
+	}
+
+	// each free slot goes to the waiting class furthest below its weighted share, so classes with nothing
+	// waiting leave their share to the others. Concurrent downloads split the bandwidth, so slots are bandwidth.
+	while (NumDownloadsInFlight < TargetDownloadsInFlight && ClassQueues.Num() > 0)
+	{
+		FName NextClass;
+		float NextClassLoad = MAX_flt;
+		for (const auto& It : ClassQueues)
+		{
+			const float ClassLoad = (ClassDownloadsInFlight.FindRef(It.Key) + 1) / GetDownloadClassWeight(It.Key);
+			if (ClassLoad < NextClassLoad || (ClassLoad == NextClassLoad && It.Value[0]->Priority > ClassQueues[NextClass][0]->Priority))
+			{
+				NextClass = It.Key;
+				NextClassLoad = ClassLoad;
+			}
+		}
+
+		TArray<TSharedRef<FPakFileRecord>>& ClassQueue = ClassQueues[NextClass];
+		TSharedRef<FPakFileRecord> DownloadPakFile = ClassQueue[0];
+		ClassQueue.RemoveAt(0);
+		if (ClassQueue.Num() <= 0)
+		{
+			ClassQueues.Remove(NextClass);
+		}
+		++ClassDownloadsInFlight.FindOrAdd(NextClass);
+		++NumDownloadsInFlight;
+		StartDownload(DownloadPakFile);
+	}
+
+	// pick up progress and results every frame until the queue drains (and the transfers it's waiting on with it)
+	if ((NumDownloadsInFlight > 0 || TransfersInFlight.Num() > 0) && !DownloadTicker.IsValid())
+	{
+		DownloadTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FChunkDownloaderCustom::UpdateDownloads));
+	}
+}
+
+void FChunkDownloaderCustom::StartDownload(const TSharedRef<FPakFileRecord>& PakFile)
+{
+	// log that we're starting a download
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Pak file %s download requested (%s)."),
+		*PakFile->Entry.FileName,
+		*PakFile->Entry.RelativeUrl
+	);
+	bNeedsManifestSave = true;
+
+	// make a new download (platform specific)
+	PakFile->Download = MakeShared<FDownloadChunk>(AsShared(), PakFile);
+	InvalidateChunkStatus(*PakFile);
+	PakFile->Download->Start();
+}
+
+bool FChunkDownloaderCustom::UpdateDownloads(float dts)
+{
+	// byte counts left by the HTTP threads, once per frame rather than per packet
+	for (const TSharedRef<FPakFileRecord>& PakFile : DownloadRequests)
+	{
+		if (PakFile->Download.IsValid())
+		{
+			PakFile->Download->UpdateProgress();
+		}
+	}
+
+	// finished transfers, as many as the frame budget allows (completing one may start or cancel others)
+	FDownloadResult Result;
+	int32 NumCompleted = 0;
+	bool bCanceledTransferDrained = false;
+	while ((NumCompleted == 0 || GameThreadWork->HasBudget()) && DownloadResults->Dequeue(Result))
+	{
+		// the worker is done with the file, it can be deleted or downloaded again
+		int32* NumTransfers = TransfersInFlight.Find(Result.FileName);
+		if (ensure(NumTransfers != nullptr) && --(*NumTransfers) <= 0)
+		{
+			TransfersInFlight.Remove(Result.FileName);
+			if (DeferredFileDeletes.Remove(Result.FileName) > 0)
+			{
+				DeleteCachedFile(Result.FileName);
+			}
+		}
+
+		TSharedPtr<FDownloadChunk> Download = Result.Download.Pin();
+		if (Download.IsValid() && !Download->HasCompleted())
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Download->OnDownloadComplete(Result.Url, Result.TryNumber, Result.HttpStatus, Result.bFileIsValid);
+			GameThreadWork->Record(TEXT("Download completion"), StartTime);
+			++NumCompleted;
+		}
+		else
+		{
+			bCanceledTransferDrained = true;
+		}
+	}
+
+	// a request for the same pak may have been waiting on it
+	if (bCanceledTransferDrained)
+	{
+		IssueDownloads();
+	}
+
+	bool bDownloadsPending = DownloadRequests.Num() > 0 || !DownloadResults->IsEmpty() || TransfersInFlight.Num() > 0;
+	if (!bDownloadsPending)
+	{
+		DownloadTicker.Reset();
+	}
+	return bDownloadsPending; // keep ticking
+}
+
+bool FChunkDownloaderCustom::DeleteCachedFile(const FString& FileName)
+{
+	// the transfer writing it may have been canceled but not finished yet, delete it once its result is drained
+	if (TransfersInFlight.Contains(FileName))
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Deleting %s once its transfer has finished."), *FileName);
+		DeferredFileDeletes.Add(FileName);
+		return true;
+	}
+	return IFileManager::Get().Delete(*(CacheFolder / FileName));
+}
+
+bool FChunkDownloaderCustom::CanVerifyPakFile(const FPakFileRecord& PakFile)
+{
+	// embedded paks are immutable, and we only know how to validate certain hash versions
+	return !PakFile.bIsEmbedded && PakFile.Entry.FileVersion.StartsWith(TEXT("SHA1:"));
+}
+
+bool FChunkDownloaderCustom::IsPakFileVerified(const FPakFileRecord& PakFile) const
+{
+	if (!CanVerifyPakFile(PakFile))
+	{
+		// nothing more to check than the size
+		return true;
+	}
+
+	// a verification is only good as long as the file hasn't been modified since
+	return PakFile.VerifyStatus == EVerifyStatus::Verified && 
+		IFileManager::Get().GetTimeStamp(*(CacheFolder / PakFile.Entry.FileName)) == PakFile.VerifiedTimeStamp;
+}
+
+void FChunkDownloaderCustom::MarkPakFileVerified(FPakFileRecord& PakFile)
+{
+	PakFile.VerifyStatus = EVerifyStatus::Verified;
+	PakFile.VerifiedTimeStamp = IFileManager::Get().GetTimeStamp(*(CacheFolder / PakFile.Entry.FileName));
+	PakFile.VerifiedAt = FDateTime::UtcNow();
+	bNeedsVerifiedManifestSave = true;
+}
+
+void FChunkDownloaderCustom::EvictPakFile(FPakFileRecord& PakFile)
+{
+	check(!PakFile.bIsEmbedded);
+	check(!PakFile.bIsMounted);
+
+	FString FullPathOnDisk = CacheFolder / PakFile.Entry.FileName;
+	if (ensure(DeleteCachedFile(PakFile.Entry.FileName)))
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Deleted invalid pak %s (chunk %d)."), *FullPathOnDisk, PakFile.Entry.ChunkId);
+		PakFile.bIsCached = false;
+		PakFile.SizeOnDisk = 0;
+		PakFile.VerifyStatus = EVerifyStatus::Unverified;
+		InvalidateChunkStatus(PakFile);
+		bNeedsManifestSave = true;
+		bNeedsVerifiedManifestSave = true;
+	}
+	else
+	{
+		// it would only be verified and evicted again on every mount, fail them instead for the rest of the session
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Unable to delete invalid pak %s (chunk %d)."), *FullPathOnDisk, PakFile.Entry.ChunkId);
+		PakFile.VerifyStatus = EVerifyStatus::Failed;
+		InvalidateChunkStatus(PakFile);
+	}
+}
+
+void FChunkDownloaderCustom::InvalidatePakFile(const TSharedRef<FPakFileRecord>& PakFile)
+{
+	if (PakFile->bIsMounted)
+	{
+		RepairMountedPakFile(PakFile);
+	}
+	else
+	{
+		EvictPakFile(*PakFile);
+	}
+}
+
+void FChunkDownloaderCustom::RepairMountedPakFile(const TSharedRef<FPakFileRecord>& PakFile)
+{
+	TSharedRef<FChunk>* ChunkPtr = Chunks.Find(PakFile->Entry.ChunkId);
+	if (!ensure(ChunkPtr != nullptr))
+	{
+		return;
+	}
+	FChunk& Chunk = **ChunkPtr;
+
+	// the pak was mounted before it was fully verified, so the chunk needs to be unmounted before we can replace it
+	UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Unmounting chunk %d to repair %s."), Chunk.ChunkId, *PakFile->Entry.FileName);
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	int32 ChunkId = Chunk.ChunkId;
+	bool bRemount = Chunk.bIsMounted;
+	bool bPreScanAssets = Chunk.bPreScanAssets;
+	UnmountChunkInternal(Chunk, [WeakThisPtr, PakFile, ChunkId, bRemount, bPreScanAssets](bool) {
+		TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+		if (!SharedThis.IsValid())
+		{
+			return;
+		}
+
+		if (!PakFile->bIsMounted && PakFile->bIsCached)
+		{
+			SharedThis->EvictPakFile(*PakFile);
+			SharedThis->SaveLocalManifest(false);
+		}
+
+		// mounting again will download the evicted pak
+		if (bRemount)
+		{
+			SharedThis->MountChunkById(ChunkId, FCallback(), bPreScanAssets);
+		}
+	});
+}
+
+void FChunkDownloaderCustom::VerifyPakFileInternal(const TSharedRef<FPakFileRecord>& PakFile, const FCallback& Callback, EQueuedWorkPriority Priority)
+{
+	check(PakFile->bIsCached);
+
+	// just piggyback on the existing post-verify callback
+	if (Callback)
+	{
+		PakFile->PostVerifyCallbacks.Add(Callback);
+	}
+
+	// see if the verification is already started
+	if (PakFile->VerifyStatus == EVerifyStatus::Verifying)
+	{
+		return;
+	}
+	PakFile->VerifyStatus = EVerifyStatus::Verifying;
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Verifying %s (chunk %d)."), *PakFile->Entry.FileName, PakFile->Entry.ChunkId);
+
+	// hash the file in the background, then report back on the game thread (within the game thread work budget)
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	FString FullPathOnDisk = CacheFolder / PakFile->Entry.FileName;
+	FString FileVersion = PakFile->Entry.FileVersion;
+	AsyncPool(*GThreadPool, [WeakThisPtr, PakFile, FullPathOnDisk, FileVersion]() {
+		const bool bFileIsValid = CheckFileSha1Hash(FullPathOnDisk, FileVersion);
+		AsyncTask(ENamedThreads::GameThread, [WeakThisPtr, PakFile, bFileIsValid]() {
+			TSharedPtr<FChunkDownloaderCustom> Downloader = WeakThisPtr.Pin();
+			if (Downloader.IsValid())
+			{
+				Downloader->DeferWork(TEXT("Verification"), [WeakThisPtr, PakFile, bFileIsValid]() {
+					TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+					if (SharedThis.IsValid())
+					{
+						SharedThis->CompleteVerification(PakFile, bFileIsValid);
+					}
+				});
+			}
+		});
+	}, nullptr, Priority);
+}
+
+void FChunkDownloaderCustom::CompleteVerification(const TSharedRef<FPakFileRecord>& PakFile, bool bFileIsValid)
+{
+	PakFile->VerifyStatus = EVerifyStatus::Unverified;
+
+	// make sure the file wasn't flushed or orphaned while we were hashing it
+	bool bSuccess = false;
+	const TSharedRef<FPakFileRecord>* CurrentPakFile = PakFiles.Find(PakFile->Entry.FileName);
+	if (CurrentPakFile != nullptr && *CurrentPakFile == PakFile && PakFile->bIsCached)
+	{
+		if (bFileIsValid)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("%s matches hash '%s'."), *PakFile->Entry.FileName, *PakFile->Entry.FileVersion);
+			MarkPakFileVerified(*PakFile);
+			bSuccess = true;
+		}
+		else
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("%s does NOT match hash '%s'."), *PakFile->Entry.FileName, *PakFile->Entry.FileVersion);
+			InvalidatePakFile(PakFile);
+		}
+	}
+
+	// queue up callbacks
+	TArray<FCallback> Callbacks = MoveTemp(PakFile->PostVerifyCallbacks);
+	PakFile->PostVerifyCallbacks.Empty();
+	for (const FCallback& Callback : Callbacks)
+	{
+		ExecuteNextTick(Callback, bSuccess);
+	}
+
+	// resave manifests if needed
+	SaveLocalManifest(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+// a file being verified by the cache scrubber, hashed one slice at a time on a worker thread
+struct FChunkDownloaderCustom::FCacheScrub
+{
+	FString FileName;
+	FString FileVersion;
+	FString FullPathOnDisk;
+	FDateTime TimeStamp;
+	int64 FileSize = 0;
+
+	// progress (only touched by the worker while a slice is in flight)
+	FSHA1 HashContext;
+	int64 Offset = 0;
+	int64 SliceSize = 0;
+	bool bReadError = false;
+};
+
+void FChunkDownloaderCustom::StartCacheScrubber(int64 BytesPerSecond)
+{
+	check(BytesPerSecond > 0);
+	ScrubBytesPerSecond = BytesPerSecond;
+	if (!ScrubTicker.IsValid())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Starting cache scrubber (%lld bytes per second)."), BytesPerSecond);
+		ScrubBudget = 0.0;
+		ScrubTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FChunkDownloaderCustom::UpdateCacheScrubber));
+	}
+}
+
+void FChunkDownloaderCustom::StopCacheScrubber()
+{
+	if (ScrubTicker.IsValid())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Stopping cache scrubber."));
+		FTSTicker::GetCoreTicker().RemoveTicker(ScrubTicker);
+		ScrubTicker.Reset();
+	}
+
+	// any slice in flight will be ignored
+	CacheScrub.Reset();
+	bCacheScrubInFlight = false;
+}
+
+bool FChunkDownloaderCustom::IsIdle() const
+{
+	return PostLoadCallbacks.Num() <= 0 && DownloadRequests.Num() <= 0 && PendingMountTasks.Num() <= 0;
+}
+
+bool FChunkDownloaderCustom::UpdateCacheScrubber(float dts)
+{
+	// one slice at a time
+	if (bCacheScrubInFlight)
+	{
+		return true;
+	}
+
+	// only while idle, pausing also drops any accumulated budget
+	if (!IsIdle())
+	{
+		ScrubBudget = 0.0;
+		return true;
+	}
+
+	// accumulate budget (at most a second's worth)
+	ScrubBudget = FMath::Min(ScrubBudget + ScrubBytesPerSecond * (double)dts, (double)ScrubBytesPerSecond);
+
+	// the file we were checking may have been deleted, orphaned or replaced since the last slice
+	if (CacheScrub.IsValid())
+	{
+		const TSharedRef<FPakFileRecord>* PakFilePtr = PakFiles.Find(CacheScrub->FileName);
+		if (PakFilePtr == nullptr || !(*PakFilePtr)->bIsCached || (*PakFilePtr)->Entry.FileVersion != CacheScrub->FileVersion)
+		{
+			CacheScrub.Reset();
+		}
+	}
+
+	// pick the next file after the cursor (wrapping around)
+	if (!CacheScrub.IsValid())
+	{
+		const FPakFileRecord* FirstFile = nullptr;
+		const FPakFileRecord* NextFile = nullptr;
+		for (const auto& It : PakFiles)
+		{
+			const FPakFileRecord& PakFile = *It.Value;
+			if (!PakFile.bIsCached || !CanVerifyPakFile(PakFile) || PakFile.VerifyStatus == EVerifyStatus::Verifying || PakFile.VerifyStatus == EVerifyStatus::Failed)
+			{
+				continue;
+			}
+			if (FirstFile == nullptr || PakFile.Entry.FileName < FirstFile->Entry.FileName)
+			{
+				FirstFile = &PakFile;
+			}
+			if (PakFile.Entry.FileName > ScrubCursor && (NextFile == nullptr || PakFile.Entry.FileName < NextFile->Entry.FileName))
+			{
+				NextFile = &PakFile;
+			}
+		}
+		if (NextFile == nullptr)
+		{
+			NextFile = FirstFile;
+		}
+		if (NextFile == nullptr)
+		{
+			// nothing to check
+			return true;
+		}
+
+		CacheScrub = MakeShared<FCacheScrub, ESPMode::ThreadSafe>();
+		CacheScrub->FileName = NextFile->Entry.FileName;
+		CacheScrub->FileVersion = NextFile->Entry.FileVersion;
+		CacheScrub->FullPathOnDisk = CacheFolder / NextFile->Entry.FileName;
+		CacheScrub->TimeStamp = IFileManager::Get().GetTimeStamp(*CacheScrub->FullPathOnDisk);
+		CacheScrub->FileSize = (int64)NextFile->Entry.FileSize;
+	}
+
+	// wait until we can afford the next slice
+	static const int64 MAX_SLICE_SIZE = 1024 * 1024;
+	const int64 SliceSize = FMath::Min3(CacheScrub->FileSize - CacheScrub->Offset, MAX_SLICE_SIZE, ScrubBytesPerSecond);
+	if (ScrubBudget < SliceSize)
+	{
+		return true;
+	}
+	ScrubBudget -= SliceSize;
+
+	// hash the slice in the background
+	TSharedRef<FCacheScrub, ESPMode::ThreadSafe> Scrub = CacheScrub.ToSharedRef();
+	Scrub->SliceSize = SliceSize;
+	bCacheScrubInFlight = true;
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	AsyncPool(*GThreadPool, [WeakThisPtr, Scrub]() {
+		IFileHandle* FilePtr = IPlatformFile::GetPlatformPhysical().OpenRead(*Scrub->FullPathOnDisk);
+		if (FilePtr != nullptr && FilePtr->Seek(Scrub->Offset) && HashFileRange(*FilePtr, Scrub->SliceSize, Scrub->HashContext, Scrub->FullPathOnDisk))
+		{
+			Scrub->Offset += Scrub->SliceSize;
+		}
+		else
+		{
+			Scrub->bReadError = true;
+		}
+		delete FilePtr;
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThisPtr, Scrub]() {
+			TSharedPtr<FChunkDownloaderCustom> Downloader = WeakThisPtr.Pin();
+			if (Downloader.IsValid())
+			{
+				Downloader->DeferWork(TEXT("Cache scrub"), [WeakThisPtr, Scrub]() {
+					TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+					if (SharedThis.IsValid())
+					{
+						SharedThis->CompleteCacheScrubSlice(Scrub);
+					}
+				});
+			}
+		});
+	}, nullptr, EQueuedWorkPriority::Lowest);
+
+	return true;
+}
+
+void FChunkDownloaderCustom::CompleteCacheScrubSlice(const TSharedRef<FCacheScrub, ESPMode::ThreadSafe>& Scrub)
+{
+	// ignore slices from a stopped scrubber
+	if (CacheScrub != Scrub)
+	{
+		return;
+	}
+	bCacheScrubInFlight = false;
+
+	// keep going until the whole file is hashed
+	if (!Scrub->bReadError && Scrub->Offset < Scrub->FileSize)
+	{
+		return;
+	}
+	CacheScrub.Reset();
+
+	// make sure the file is still the one we started with
+	const TSharedRef<FPakFileRecord>* PakFilePtr = PakFiles.Find(Scrub->FileName);
+	if (PakFilePtr == nullptr || !(*PakFilePtr)->bIsCached || (*PakFilePtr)->Entry.FileVersion != Scrub->FileVersion ||
+		IFileManager::Get().GetTimeStamp(*Scrub->FullPathOnDisk) != Scrub->TimeStamp)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("%s changed while being scrubbed, skipping it."), *Scrub->FileName);
+		return;
+	}
+	const TSharedRef<FPakFileRecord>& PakFile = *PakFilePtr;
+
+	const bool bFileIsValid = !Scrub->bReadError && FinalizeSha1HashString(Scrub->HashContext) == Scrub->FileVersion;
+	if (bFileIsValid)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Scrubbed %s, matches hash '%s'."), *PakFile->Entry.FileName, *PakFile->Entry.FileVersion);
+		if (PakFile->VerifyStatus != EVerifyStatus::Verifying)
+		{
+			MarkPakFileVerified(*PakFile);
+		}
+	}
+	else if (PakFile->bIsMounted)
+	{
+		// don't pull the pak out from under the game, but make sure it's verified again before it's mounted next time
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Scrubbed %s, does NOT match hash '%s' (chunk %d is mounted)."), *PakFile->Entry.FileName, *PakFile->Entry.FileVersion, PakFile->Entry.ChunkId);
+		if (PakFile->VerifyStatus != EVerifyStatus::Verifying)
+		{
+			PakFile->VerifyStatus = EVerifyStatus::Unverified;
+		}
+		bNeedsVerifiedManifestSave = true;
+	}
+	else
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Scrubbed %s, does NOT match hash '%s'."), *PakFile->Entry.FileName, *PakFile->Entry.FileVersion);
+		EvictPakFile(*PakFile);
+	}
+
+	// move the cursor along (saved with the verified manifest)
+	ScrubCursor = Scrub->FileName;
+	bNeedsVerifiedManifestSave = true;
+	SaveLocalManifest(false);
+
+	OnCacheScrubbed.Broadcast(PakFile->Entry.FileName, PakFile->Entry.ChunkId, bFileIsValid);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void FChunkDownloaderCustom::StartBackgroundInstall()
+{
+	// remember it across sessions
+	WriteStringAsUtf8TextFile(FDateTime::UtcNow().ToString(), CacheFolder / BACKGROUND_INSTALL_MARKER);
+
+	if (!BackgroundInstallTicker.IsValid())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Starting background install."));
+		BackgroundInstallPauseReason = nullptr;
+		BackgroundInstallTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FChunkDownloaderCustom::UpdateBackgroundInstall), 1.0f);
+	}
+}
+
+void FChunkDownloaderCustom::StopBackgroundInstall()
+{
+	IFileManager::Get().Delete(*(CacheFolder / BACKGROUND_INSTALL_MARKER), false, false, true);
+
+	if (BackgroundInstallTicker.IsValid())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Stopping background install."));
+		FTSTicker::GetCoreTicker().RemoveTicker(BackgroundInstallTicker);
+		BackgroundInstallTicker.Reset();
+	}
+
+	PauseBackgroundInstall();
+	BackgroundInstallPauseReason = nullptr;
+	BackgroundInstallSkipped.Empty();
+}
+
+FBackgroundInstallProgress FChunkDownloaderCustom::GetBackgroundInstallProgress() const
+{
+	FBackgroundInstallProgress Progress;
+	Progress.bActive = IsBackgroundInstalling();
+	for (const auto& It : Chunks)
+	{
+		const FChunk& Chunk = *It.Value;
+		if (Chunk.PakFiles.Num() <= 0)
+		{
+			continue;
+		}
+
+		RefreshChunkStatus(Chunk);
+		++Progress.TotalChunks;
+		if (Chunk.CachedStatus == EChunkStatus::Cached || Chunk.CachedStatus == EChunkStatus::Mounted)
+		{
+			++Progress.ChunksCached;
+		}
+		Progress.BytesCached += Chunk.CachedBytesCached;
+		Progress.TotalBytes += Chunk.CachedBytesTotal;
+	}
+	Progress.bPaused = Progress.bActive && BackgroundInstallPauseReason != nullptr && Progress.ChunksCached < Progress.TotalChunks;
+
+	// assumes the background install gets the whole bandwidth, which is what it waits for
+	if (DownloadBandwidth > 0.0)
+	{
+		Progress.EstimatedTimeRemaining = FTimespan::FromSeconds((Progress.TotalBytes - Progress.BytesCached) / DownloadBandwidth);
+	}
+	return Progress;
+}
+
+bool FChunkDownloaderCustom::UpdateBackgroundInstall(float dts)
+{
+	// one chunk at a time
+	if (BackgroundInstallChunk != INDEX_NONE)
+	{
+		return true;
+	}
+
+	// the lowest chunk id that isn't cached yet, so the install goes through the catalog in a predictable order
+	const FChunk* NextChunk = nullptr;
+	for (const auto& It : Chunks)
+	{
+		const FChunk& Chunk = *It.Value;
+		if (Chunk.PakFiles.Num() <= 0 || BackgroundInstallSkipped.Contains(Chunk.ChunkId))
+		{
+			continue;
+		}
+
+		RefreshChunkStatus(Chunk);
+		if (Chunk.CachedStatus != EChunkStatus::Cached && Chunk.CachedStatus != EChunkStatus::Mounted && (NextChunk == nullptr || Chunk.ChunkId < NextChunk->ChunkId))
+		{
+			NextChunk = &Chunk;
+		}
+	}
+
+	// log whenever we start or stop waiting (keep ticking once everything is cached, a new build may add chunks)
+	const TCHAR* PauseReason = NextChunk != nullptr ? GetBackgroundInstallPauseReason(*NextChunk) : TEXT("all chunks are cached");
+	if (PauseReason != BackgroundInstallPauseReason)
+	{
+		if (PauseReason != nullptr)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Background install waiting (%s)."), PauseReason);
+		}
+		else
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Background install resuming."));
+		}
+		BackgroundInstallPauseReason = PauseReason;
+	}
+	if (PauseReason != nullptr)
+	{
+		return true;
+	}
+
+	// lowest priority and a light download class, so anything requested meanwhile goes first
+	const int32 ChunkId = NextChunk->ChunkId;
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Background install downloading chunk %d (%llu bytes missing)."), ChunkId, NextChunk->CachedBytesTotal - NextChunk->CachedBytesCached);
+	BackgroundInstallChunk = ChunkId;
+	TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+	DownloadChunkInternal(*NextChunk, [WeakThisPtr, ChunkId](bool bSuccess) {
+		TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+		if (!SharedThis.IsValid() || SharedThis->BackgroundInstallChunk != ChunkId)
+		{
+			return; // paused or stopped meanwhile (see PauseBackgroundInstall)
+		}
+		SharedThis->BackgroundInstallChunk = INDEX_NONE;
+
+		// don't keep retrying the same chunk this session
+		if (!bSuccess)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Background install failed to download chunk %d, skipping it."), ChunkId);
+			SharedThis->BackgroundInstallSkipped.Add(ChunkId);
+		}
+	}, MIN_int32, BACKGROUND_INSTALL_DOWNLOAD_CLASS);
+	return true;
+}
+
+const TCHAR* FChunkDownloaderCustom::GetBackgroundInstallPauseReason(const FChunk& Chunk) const
+{
+	if (BuildBaseUrls.Num() <= 0)
+	{
+		return TEXT("no CDN urls");
+	}
+	if (PostLoadCallbacks.Num() > 0)
+	{
+		return TEXT("loading mode");
+	}
+	if (DownloadRequests.Num() > 0)
+	{
+		return TEXT("other downloads queued");
+	}
+
+	// leave room on the device for everything else
+	const uint64 BytesNeeded = Chunk.CachedBytesTotal - Chunk.CachedBytesCached;
+	uint64 TotalDiskSpace = 0;
+	uint64 TotalDiskFreeSpace = 0;
+	if (FPlatformMisc::GetDiskTotalAndFreeSpace(CacheFolder, TotalDiskSpace, TotalDiskFreeSpace) && TotalDiskFreeSpace < BytesNeeded + (uint64)FMath::Max<int64>(BackgroundInstallMinFreeBytes, 0))
+	{
+		return TEXT("not enough free disk space");
+	}
+
+	// and stay within our own share of it
+	if (BackgroundInstallMaxCacheBytes > 0)
+	{
+		uint64 CacheBytes = 0;
+		for (const auto& It : PakFiles)
+		{
+			if (!It.Value->bIsEmbedded)
+			{
+				CacheBytes += It.Value->SizeOnDisk;
+			}
+		}
+		if (CacheBytes + BytesNeeded > (uint64)BackgroundInstallMaxCacheBytes)
+		{
+			return TEXT("cache quota reached");
+		}
+	}
+	return nullptr;
+}
+
+void FChunkDownloaderCustom::PauseBackgroundInstall()
+{
+	if (BackgroundInstallChunk == INDEX_NONE)
+	{
+		return;
+	}
+	const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(BackgroundInstallChunk);
+	BackgroundInstallChunk = INDEX_NONE;
+	if (ChunkPtr == nullptr)
+	{
+		return;
+	}
+
+	// drop the paks nobody but the background install is waiting on. The chunk is picked up again once we're idle,
+	// and partial files resume where they left off.
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Pausing background install of chunk %d."), (*ChunkPtr)->ChunkId);
+	for (const TSharedRef<FPakFileRecord>& PakFile : (*ChunkPtr)->PakFiles)
+	{
+		if (PakFile->Priority != MIN_int32 || PakFile->DownloadClass != BACKGROUND_INSTALL_DOWNLOAD_CLASS || !DownloadRequests.Contains(PakFile))
+		{
+			continue;
+		}
+
+		if (PakFile->Download.IsValid())
+		{
+			CancelDownload(PakFile, false);
+			continue;
+		}
+
+		DownloadRequests.RemoveSingle(PakFile);
+		DownloadRequestBytesRemaining -= PakFile->Entry.FileSize;
+		PakFile->DownloadClass = NAME_None;
+		for (const FCallback& Callback : PakFile->PostDownloadCallbacks)
+		{
+			ExecuteNextTick(Callback, false);
+		}
+		PakFile->PostDownloadCallbacks.Empty();
+	}
+}
+
+bool FChunkDownloaderCustom::IsReadyToMount(const FChunk& Chunk) const
+{
+	// nothing in flight, nothing to download and nothing to verify first
+	if (Chunk.MountTask != nullptr)
+	{
+		return false;
+	}
+	for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+	{
+		if (!PakFile->bIsCached || (!PakFile->bIsMounted && !bLazyMountVerification && !IsPakFileVerified(*PakFile)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FChunkDownloaderCustom::CreateMountTask(FChunk& Chunk, bool bPreScanAssets, const FCallback& Callback, const TSharedPtr<FMountBatch>& Batch)
+{
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d mount requested (%d pak sequence)."), Chunk.ChunkId, Chunk.PakFiles.Num());
+
+	// spin up a background task to mount the pak file
+	check(Chunk.MountTask == nullptr);
+	Chunk.MountTask = new FMountTask();
+
+	// configure the task
+	FPakMountWork& MountWork = Chunk.MountTask->GetTask();
+	MountWork.ChunkId = Chunk.ChunkId;
+	MountWork.bIsUnmountTask = false;
+	MountWork.bPreScanAssets = bPreScanAssets;
+	MountWork.NumVerificationSamples = NumLazyVerificationSamples;
+	MountWork.CacheFolder = CacheFolder;
+	MountWork.EmbeddedFolder = EmbeddedFolder;
+	for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+	{
+		if (PakFile->IsAssetRegistryFragment())
+		{
+			// it's cached along with the paks and loaded by the worker
+			MountWork.RegistryFragmentFile = PakFile;
+			MountWork.bVerifyRegistryFragment = bLazyMountVerification && !IsPakFileVerified(*PakFile);
+		}
+		else if (!PakFile->bIsMounted)
+		{
+			MountWork.PakFiles.Add(PakFile);
+			if (bLazyMountVerification && !IsPakFileVerified(*PakFile))
+			{
+				MountWork.PakFilesToSample.Add(PakFile);
+			}
+		}
+	}
+	if (Callback)
+	{
+		MountWork.PostMountCallbacks.Add(Callback);
+	}
+	if (Batch.IsValid())
+	{
+		MountWork.Batch = Batch;
+		MountWork.bDeferRegistration = true;
+		++Batch->NumTasks;
+	}
+
+	// start as a background task
+	StartMountTask(Chunk);
+}
+
+void FChunkDownloaderCustom::StartMountTask(FChunk& Chunk)
+{
+	check(Chunk.MountTask != nullptr);
+
+	// track the task until its worker reports back
+	FPakMountWork& MountWork = Chunk.MountTask->GetTask();
+	MountWork.TaskId = ++NextMountTaskId;
+	MountWork.CompletionQueue = &MountCompletions;
+	PendingMountTasks.Add(MountWork.TaskId, Chunk.MountTask);
+
+	// start as a background task
+	Chunk.MountTask->StartBackgroundTask();
+
+	// start a per-frame ticker until mounts are finished
+	if (!MountTicker.IsValid())
+	{
+		MountTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FChunkDownloaderCustom::UpdateMountTasks));
+	}
+}
+
+void FChunkDownloaderCustom::FinishMountTask(FMountTask* MountTask)
+{
+	FPakMountWork& MountWork = MountTask->GetTask();
+	TSharedRef<FChunk>& Chunk = Chunks.FindChecked(MountWork.ChunkId);
+	check(Chunk->MountTask == MountTask);
+
+	if (!MountWork.Batch.IsValid())
+	{
+		CompleteMountTask(*Chunk);
+		return;
+	}
+
+	// hold on to it until the rest of the batch is done too
+	TSharedRef<FMountBatch> Batch = MountWork.Batch.ToSharedRef();
+	if (!Batch->FinishedTasks.Contains(MountTask))
+	{
+		Batch->FinishedTasks.Add(MountTask);
+		if (Batch->FinishedTasks.Num() >= Batch->NumTasks)
+		{
+			CompleteMountBatch(Batch);
+		}
+	}
+}
+
+void FChunkDownloaderCustom::CompleteMountBatch(TSharedRef<FMountBatch> Batch)
+{
+	TArray<FMountTask*> MountTasks = MoveTemp(Batch->FinishedTasks);
+	Batch->FinishedTasks.Empty();
+
+	// register the mount points of the whole batch in one go (shared ones only once)
+	int32 NumRegistered = 0;
+	for (FMountTask* MountTask : MountTasks)
+	{
+		FPakMountWork& MountWork = MountTask->GetTask();
+		for (auto& It : MountWork.ProcessedPakFiles)
+		{
+			FPakMountWorkResult& Result = It.Value;
+			FString FullPathOnDisk = (It.Key->bIsEmbedded ? EmbeddedFolder : CacheFolder) / It.Key->Entry.FileName;
+			Result.IsRegistered = RegisterPakMountPoint(Result.Pak->GetMountPoint(), FullPathOnDisk, MountWork.ChunkId);
+			if (Result.IsRegistered == ERegistryStatus::Registered)
+			{
+				++NumRegistered;
+			}
+		}
+	}
+
+	// complete the chunks
+	TArray<int32> ChunksToScan;
+	for (FMountTask* MountTask : MountTasks)
+	{
+		int32 ChunkId = MountTask->GetTask().ChunkId;
+		bool bPreScanAssets = MountTask->GetTask().bPreScanAssets;
+
+		FChunk& Chunk = *Chunks.FindChecked(ChunkId);
+		CompleteMountTask(Chunk);
+		if (bPreScanAssets && Chunk.bIsMounted)
+		{
+			ChunksToScan.Add(ChunkId);
+		}
+	}
+
+	// a single Asset Registry scan for all of them
+	if (ChunksToScan.Num() > 0 && bAsyncAssetScan)
+	{
+		// callbacks and listeners wait for the scan
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Mount batch of %d chunks complete (%d mount points registered), scanning assets."), MountTasks.Num(), NumRegistered);
+		TMap<int32, uint32> UnmountSerials;
+		for (int32 ChunkId : ChunksToScan)
+		{
+			UnmountSerials.Add(ChunkId, Chunks.FindChecked(ChunkId)->UnmountSerial);
+		}
+		TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+		ScanAssetsInChunksAsync(ChunksToScan, [WeakThisPtr, Batch, UnmountSerials](bool bScanSuccess) {
+			// chunks unmounted while their assets were scanned report failure (their unmount was already broadcast)
+			TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+			for (const TPair<int32, FCallback>& PostScanCallback : Batch->PostScanCallbacks)
+			{
+				if (PostScanCallback.Value)
+				{
+					PostScanCallback.Value(bScanSuccess && SharedThis.IsValid() && SharedThis->IsStillMounted(PostScanCallback.Key, UnmountSerials.FindRef(PostScanCallback.Key)));
+				}
+			}
+			if (SharedThis.IsValid())
+			{
+				for (const TPair<int32, bool>& MountResult : Batch->MountResults)
+				{
+					const uint32* UnmountSerial = UnmountSerials.Find(MountResult.Key);
+					if (UnmountSerial == nullptr)
+					{
+						// not part of the scan (failed mounts)
+						SharedThis->OnChunkMounted.Broadcast(MountResult.Key, MountResult.Value);
+					}
+					else if (SharedThis->IsStillMounted(MountResult.Key, *UnmountSerial))
+					{
+						SharedThis->OnChunkMounted.Broadcast(MountResult.Key, MountResult.Value && bScanSuccess);
+					}
+				}
+			}
+		});
+		return;
+	}
+	if (ChunksToScan.Num() > 0)
+	{
+		const int32 ScanResult = ScanAssetsInChunks(ChunksToScan);
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("%d assets added to Asset Registry from %d batched chunks."), ScanResult, ChunksToScan.Num());
+	}
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Mount batch of %d chunks complete (%d mount points registered)."), MountTasks.Num(), NumRegistered);
+
+	// now everything is in place, let listeners know
+	for (const TPair<int32, bool>& MountResult : Batch->MountResults)
+	{
+		OnChunkMounted.Broadcast(MountResult.Key, MountResult.Value);
+	}
+	Batch->MountResults.Empty();
+}
+
+void FChunkDownloaderCustom::CompleteMountTask(FChunk& Chunk)
+{
+	check(Chunk.MountTask != nullptr);
+	check(Chunk.MountTask->IsDone());
+
+	// remove the mount
+	FMountTask* Mount = Chunk.MountTask;
+	Chunk.MountTask = nullptr;
+	verify(PendingMountTasks.Remove(Mount->GetTask().TaskId) > 0);
+	
+	// get the work
+	FPakMountWork& MountWork = Mount->GetTask();	
+	
+	FPlatformChunkInstallMultiDelegate* MulticastEvent;
+	bool bSuccess;
+	bool bDeferToAssetScan = false;
+	
+	if (!MountWork.bIsUnmountTask)
+	{
+		// update bIsMounted on paks that actually succeeded
+		for (auto& MountWorkResult : MountWork.ProcessedPakFiles)
+		{
+			const auto& PakFile = MountWorkResult.Key;
+			auto& Result = MountWorkResult.Value;
+
+			PakFile->bIsMounted = true;
+			PakFile->Pak = Result.Pak;
+			PakFile->IsRegistered = Result.IsRegistered;
+			PakFile->Content = MoveTemp(Result.Content);
+
+			// record lazy verification results
+			if (Result.VerifyStatus == EVerifyStatus::Verified)
+			{
+				MarkPakFileVerified(*PakFile);
+			}
+			else if (Result.VerifyStatus == EVerifyStatus::Sampled && PakFile->VerifyStatus != EVerifyStatus::Verifying)
+			{
+				PakFile->VerifyStatus = EVerifyStatus::Sampled;
+			}
+		}
+
+		if (MountWork.RegistryFragmentVerifyStatus == EVerifyStatus::Verified)
+		{
+			MarkPakFileVerified(*MountWork.RegistryFragmentFile);
+		}
+
+		// evict paks that failed lazy verification
+		for (const TSharedRef<FPakFileRecord>& PakFile : MountWork.FailedPakFiles)
+		{
+			EvictPakFile(*PakFile);
+		}
+
+		// update bIsMounted on the chunk
+		bool bAllPaksMounted = true;
+		bool bAllPaksUnmounted = true;
+		for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+		{
+			if (PakFile->IsAssetRegistryFragment())
+			{
+				continue;
+			}
+			if (!PakFile->bIsMounted)
+			{
+				bAllPaksMounted = false;
+				LoadingModeStats.LastError = FText::Format(LOCTEXT("FailedToMount", "Failed to mount {0}."), FText::FromString(PakFile->Entry.FileName));
+			}
+			else 
+			{
+				bAllPaksUnmounted = false;
+			}
+		}
+		Chunk.bIsMounted = bAllPaksMounted;
+		Chunk.bStatusDirty = true;
+		if (bAllPaksMounted)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d mount succeeded."), Chunk.ChunkId);
+
+			// increment chunks mounted
+			++LoadingModeStats.ChunksMounted;
+
+			// repairs mount it again the same way
+			Chunk.bPreScanAssets = MountWork.bPreScanAssets;
+
+			// merge the chunk's serialized asset registry if assets are to be scanned, so the scan doesn't have to read its files
+			IAssetRegistry* AssetRegistry = IAssetRegistry::Get();
+			if (MountWork.bPreScanAssets && MountWork.RegistryFragment.IsValid() && AssetRegistry != nullptr)
+			{
+				AssetRegistry->AppendState(*MountWork.RegistryFragment);
+				Chunk.NumRegistryFragmentAssets = MountWork.RegistryFragment->GetNumAssets();
+				UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Merged %d assets from asset registry fragment %s for chunk %d."), Chunk.NumRegistryFragmentAssets, *MountWork.RegistryFragmentFile->Entry.FileName, Chunk.ChunkId);
+			}
+
+			// now we know exactly what's in it
+			TArray<FName> Packages;
+			for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+			{
+				for (const FChunkFile& File : PakFile->Content.Files)
+				{
+					if (File.IsCooked())
+					{
+						Packages.Add(File.PackageName);
+					}
+				}
+			}
+			IndexChunkPackages(Chunk, MoveTemp(Packages));
+
+			// get its files into the OS file cache before anything loads them
+			if (bPrewarmMountedChunks)
+			{
+				PrewarmChunk(Chunk.ChunkId, TArray<FName>(), nullptr);
+			}
+
+			// If an Asset Registry scan should be performed, do so now (batches do a single one for all their chunks):
+			if (MountWork.bPreScanAssets && !MountWork.Batch.IsValid() && bAsyncAssetScan)
+			{
+				// spread over the next frames, callbacks and listeners wait for it
+				bDeferToAssetScan = true;
+			}
+			else if (MountWork.bPreScanAssets && !MountWork.Batch.IsValid())
+			{
+				const int32 ScanResult = ScanAssetsInChunk(Chunk.ChunkId);
+				UE_LOG(LogChunkDownloaderCustom, Log, TEXT("%d assets added to Asset Registry from Chunk %d."), ScanResult, Chunk.ChunkId);
+			}
+
+			// finish verifying lazily mounted paks in the background
+			for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+			{
+				if (PakFile->VerifyStatus == EVerifyStatus::Sampled)
+				{
+					VerifyPakFileInternal(PakFile, FCallback(), EQueuedWorkPriority::Lowest);
+				}
+			}
+		}
+		else if (MountWork.FailedPakFiles.Num() > 0)
+		{
+			// mounting again will download the evicted paks and mount them
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Chunk %d mount interrupted to repair %d pak files."), Chunk.ChunkId, MountWork.FailedPakFiles.Num());
+			TArray<FCallback> PostMountCallbacks = MoveTemp(MountWork.PostMountCallbacks);
+			MountChunkInternal(Chunk, MountWork.bPreScanAssets, [PostMountCallbacks](bool bMountSuccess) {
+				for (const FCallback& Callback : PostMountCallbacks)
+				{
+					if (Callback)
+					{
+						Callback(bMountSuccess);
+					}
+				}
+			});
+
+			// finally delete the task
+			delete Mount;
+			RunQueuedChunkOp(Chunk);
+			SaveLocalManifest(false);
+			ComputeLoadingStats();
+			return;
+		}
+		else
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Chunk %d mount failed."), Chunk.ChunkId);
+		}
+		MulticastEvent = &OnChunkMounted;
+		bSuccess = bAllPaksMounted;
+	}
+	else
+	{
+		// decrement chunks mounted (failed mounts were never counted)
+		if (Chunk.bIsMounted)
+		{
+			--LoadingModeStats.ChunksMounted;
+		}
+
+		// update bIsMounted on paks that actually succeeded
+		for (const auto& MountWorkResult : MountWork.ProcessedPakFiles)
+		{
+			const auto& PakFile = MountWorkResult.Key;
+			const auto& Result = MountWorkResult.Value;
+
+			PakFile->bIsMounted = false;
+			PakFile->Pak.SafeRelease();
+			PakFile->Content.Reset();
+			PakFile->IsRegistered = Result.IsRegistered;
+		}
+
+		// update bIsMounted on the chunk
+		bool bAllPaksMounted = true;
+		bool bAllPaksUnmounted = true;
+		for (const TSharedRef<FPakFileRecord>& PakFile : Chunk.PakFiles)
+		{
+			if (!PakFile->bIsMounted)
+			{
+				bAllPaksMounted = false;
+			}
+			else
+			{
+				bAllPaksUnmounted = false;
+				LoadingModeStats.LastError = FText::Format(LOCTEXT("FailedToUnmount", "Failed to unmount {0}."), FText::FromString(PakFile->Entry.FileName));				
+			}
+		}
+		Chunk.bIsMounted = bAllPaksMounted;
+		Chunk.bStatusDirty = true;
+		if (bAllPaksUnmounted)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d unmount succeeded."), Chunk.ChunkId);
+		}
+		else
+		{
+			UE_LOG(LogChunkDownloaderCustom, Error, TEXT("Chunk %d unmount failed."), Chunk.ChunkId);
+		}
+		MulticastEvent = &OnChunkUnmounted;
+		bSuccess = bAllPaksUnmounted;
+	}
+
+	if (bDeferToAssetScan)
+	{
+		// the mount itself succeeded, the scan only delays the notifications
+		TWeakPtr<FChunkDownloaderCustom> WeakThisPtr = AsShared();
+		ScanAssetsInChunksAsync({ Chunk.ChunkId }, [WeakThisPtr, ChunkId = Chunk.ChunkId, UnmountSerial = Chunk.UnmountSerial, PostMountCallbacks = MountWork.PostMountCallbacks](bool bScanSuccess) {
+			// a canceled scan or an unmount in the meantime (the unmount was already broadcast) fails the mount
+			TSharedPtr<FChunkDownloaderCustom> SharedThis = WeakThisPtr.Pin();
+			const bool bStillMounted = SharedThis.IsValid() && SharedThis->IsStillMounted(ChunkId, UnmountSerial);
+			for (const FCallback& Callback : PostMountCallbacks)
+			{
+				if (Callback)
+				{
+					Callback(bScanSuccess && bStillMounted);
+				}
+			}
+			if (bStillMounted)
+			{
+				SharedThis->OnChunkMounted.Broadcast(ChunkId, bScanSuccess);
+			}
+		});
+	}
+	else
+	{
+		// trigger the post-mount callbacks (a batch holds them back if it still has to scan its assets)
+		for (const FCallback& Callback : MountWork.PostMountCallbacks)
+		{
+			if (MountWork.Batch.IsValid() && MountWork.bPreScanAssets && bSuccess && bAsyncAssetScan)
+			{
+				MountWork.Batch->PostScanCallbacks.Emplace(Chunk.ChunkId, Callback);
+			}
+			else
+			{
+				ExecuteNextTick(Callback, bSuccess);
+			}
+		}
+
+		// also trigger the multicast event (batches wait until the whole batch is done)
+		if (MountWork.Batch.IsValid())
+		{
+			MountWork.Batch->MountResults.Emplace(Chunk.ChunkId, bSuccess);
+		}
+		else
+		{
+			MulticastEvent->Broadcast(Chunk.ChunkId, bSuccess);
+		}
+	}
+
+
+	// finally delete the task
+	delete Mount;
+
+	// start whatever was requested while the task was running
+	RunQueuedChunkOp(Chunk);
+
+	// recompute loading stats
+	ComputeLoadingStats();
+}
+
+bool FChunkDownloaderCustom::TryCancelMountTask(FChunk& Chunk)
+{
+	check(Chunk.MountTask != nullptr);
+
+	// only possible while the work is still queued in the thread pool
+	if (!Chunk.MountTask->Cancel())
+	{
+		return false;
+	}
+
+	FMountTask* Mount = Chunk.MountTask;
+	Chunk.MountTask = nullptr;
+	verify(PendingMountTasks.Remove(Mount->GetTask().TaskId) > 0);
+
+	// the opposite request supersedes this one, nothing was touched
+	const FPakMountWork& MountWork = Mount->GetTask();
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d %s canceled before it started."), Chunk.ChunkId, MountWork.bIsUnmountTask ? TEXT("unmount") : TEXT("mount"));
+	for (const FCallback& Callback : MountWork.PostMountCallbacks)
+	{
+		ExecuteNextTick(Callback, false);
+	}
+	TSharedPtr<FMountBatch> Batch = MountWork.Batch;
+	delete Mount;
+
+	// anything queued behind it would now be redundant
+	DiscardQueuedChunkOp(Chunk);
+
+	// the rest of its batch may have been waiting on it
+	if (Batch.IsValid())
+	{
+		--Batch->NumTasks;
+		if (Batch->NumTasks > 0 && Batch->FinishedTasks.Num() >= Batch->NumTasks)
+		{
+			CompleteMountBatch(Batch.ToSharedRef());
+		}
+	}
+	return true;
+}
+
+void FChunkDownloaderCustom::QueueChunkOp(FChunk& Chunk, EChunkMountOp Op, bool bPreScanAssets, const FCallback& Callback)
+{
+	check(Chunk.MountTask != nullptr);
+	check(Op != EChunkMountOp::None);
+	check(Chunk.QueuedOp == EChunkMountOp::None || Chunk.QueuedOp == Op);
+
+	Chunk.QueuedOp = Op;
+	Chunk.bQueuedPreScanAssets |= bPreScanAssets;
+	if (Callback)
+	{
+		Chunk.QueuedCallbacks.Add(Callback);
+	}
+}
+
+void FChunkDownloaderCustom::DiscardQueuedChunkOp(FChunk& Chunk)
+{
+	if (Chunk.QueuedOp == EChunkMountOp::None)
+	{
+		return;
+	}
+
+	UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d queued %s dropped (superseded)."), Chunk.ChunkId, Chunk.QueuedOp == EChunkMountOp::Mount ? TEXT("mount") : TEXT("unmount"));
+	for (const FCallback& Callback : Chunk.QueuedCallbacks)
+	{
+		ExecuteNextTick(Callback, false);
+	}
+	Chunk.QueuedOp = EChunkMountOp::None;
+	Chunk.bQueuedPreScanAssets = false;
+	Chunk.QueuedCallbacks.Empty();
+}
+
+void FChunkDownloaderCustom::RunQueuedChunkOp(FChunk& Chunk)
+{
+	EChunkMountOp Op = Chunk.QueuedOp;
+	if (Op == EChunkMountOp::None)
+	{
+		return;
+	}
+
+	bool bPreScanAssets = Chunk.bQueuedPreScanAssets;
+	TArray<FCallback> Callbacks = MoveTemp(Chunk.QueuedCallbacks);
+	Chunk.QueuedOp = EChunkMountOp::None;
+	Chunk.bQueuedPreScanAssets = false;
+	Chunk.QueuedCallbacks.Empty();
+
+	// the first call starts the operation, the rest join it. These were requested (and recorded) already,
+	// so they go straight to the internal paths.
+	if (Callbacks.Num() <= 0)
+	{
+		Callbacks.Add(FCallback());
+	}
+	for (const FCallback& Callback : Callbacks)
+	{
+		if (Op == EChunkMountOp::Mount)
+		{
+			if (Chunk.bIsMounted && Chunk.MountTask == nullptr)
+			{
+				ExecuteNextTick(Callback, true);
+			}
+			else
+			{
+				MountChunkInternal(Chunk, bPreScanAssets, Callback);
+			}
+		}
+		else
+		{
+			// including mounts started since it was queued (e.g. the repair of a failed mount)
+			++Chunk.UnmountSerial;
+			if (!Chunk.bIsMounted && Chunk.MountTask == nullptr)
+			{
+				ExecuteNextTick(Callback, true);
+			}
+			else
+			{
+				UnmountChunkInternal(Chunk, Callback);
+			}
+		}
+	}
+}
+
+bool FChunkDownloaderCustom::IsMountSuperseded(int32 ChunkId, uint32 UnmountSerial) const
+{
+	const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+	if (ChunkPtr != nullptr && (*ChunkPtr)->UnmountSerial != UnmountSerial)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Log, TEXT("Chunk %d mount dropped (unmount requested since)."), ChunkId);
+		return true;
+	}
+	return false;
+}
+
+bool FChunkDownloaderCustom::IsStillMounted(int32 ChunkId, uint32 UnmountSerial) const
+{
+	const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+	return ChunkPtr != nullptr && (*ChunkPtr)->bIsMounted && (*ChunkPtr)->UnmountSerial == UnmountSerial;
+}
+
+bool FChunkDownloaderCustom::UpdateMountTasks(float dts)
+{
+	// only look at the tasks whose workers have reported back, as many as the frame budget allows
+	uint32 TaskId = 0;
+	int32 NumFinished = 0;
+	while ((NumFinished == 0 || GameThreadWork->HasBudget()) && MountCompletions.Dequeue(TaskId))
+	{
+		// tasks completed by WaitForMounts will still be in the queue
+		FMountTask** MountTaskPtr = PendingMountTasks.Find(TaskId);
+		if (MountTaskPtr == nullptr)
+		{
+			continue;
+		}
+
+		// the worker reports back right before the task is flagged done
+		FMountTask* MountTask = *MountTaskPtr;
+		MountTask->EnsureCompletion(false);
+
+		// complete it
+		const double StartTime = FPlatformTime::Seconds();
+		FinishMountTask(MountTask);
+		GameThreadWork->Record(TEXT("Mount completion"), StartTime);
+		++NumFinished;
+	}
+
+	bool bMountsPending = PendingMountTasks.Num() > 0;
+
+	if (!bMountsPending)
+	{
+		MountTicker.Reset();
+	}
+	return bMountsPending; // keep ticking
+}
+
+void FChunkDownloaderCustom::DownloadChunk(int32 ChunkId, const FCallback& Callback, int32 Priority, FName DownloadClass)
+{
+	// look up the chunk
+	TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+	if (ChunkPtr == nullptr || (*ChunkPtr)->PakFiles.Num() <= 0)
+	{
+		// a chunk that doesn't exist or one with no pak files are both considered "complete" for the purposes of this call
+		// use GetChunkStatus to differentiate from chunks that mounted successfully
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring download request for chunk %d (no mapped pak files)."), ChunkId);
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+	const FChunk& Chunk = **ChunkPtr;
+
+	// if all the paks are cached, just succeed
+	if (Chunk.IsCached())
+	{
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	// queue the download
+	DownloadChunkInternal(Chunk, Callback, Priority, DownloadClass);
+
+	// resave manifest if needed
+	SaveLocalManifest(false);
+	ComputeLoadingStats();
+}
+
+void FChunkDownloaderCustom::DownloadChunk(int32 ChunkId, const FTimespan& Deadline, const FCallback& Callback, int32 Priority, FName DownloadClass)
+{
+	// deadlines need to be known before the requests are queued
+	if (const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId))
+	{
+		SetChunkDeadline(**ChunkPtr, FDateTime::UtcNow() + Deadline);
+	}
+	DownloadChunk(ChunkId, Callback, Priority, DownloadClass);
+
+	// warn right away if it's already hopeless
+	CheckDeadlines();
+}
+
+void FChunkDownloaderCustom::DownloadChunks(const TArray<int32>& ChunkIds, const FCallback& Callback, int32 Priority, FName DownloadClass)
+{
+	// convert to chunk references
+	TArray<TSharedRef<FChunk>> ChunksToDownload;
+	for (int32 ChunkId : ChunkIds)
+	{
+		TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+		if (ChunkPtr != nullptr)
+		{
+			TSharedRef<FChunk>& ChunkRef = *ChunkPtr;
+			if (ChunkRef->PakFiles.Num() > 0)
+			{
+				if (!ChunkRef->IsCached())
+				{
+					ChunksToDownload.Add(ChunkRef);
+				}
+				continue;
+			}
+		}
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring download request for chunk %d (no mapped pak files)."), ChunkId);
+	}
+
+	// make sure there are some chunks to mount (saves a frame)
+	if (ChunksToDownload.Num() <= 0)
+	{
+		// trivial success
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	// if there's no callback for some reason, avoid a bunch of boilerplate
+#ifndef PVS_STUDIO // Build machine refuses to disable this warning
+	if (Callback)
+	{
+		// loop over chunks and issue individual callback
+		FMultiCallback* MultiCallback = new FMultiCallback(Callback);
+		for (const TSharedRef<FChunk>& Chunk : ChunksToDownload)
+		{
+			DownloadChunkInternal(*Chunk, MultiCallback->AddPending(), Priority, DownloadClass);
+		}
+		check(MultiCallback->GetNumPending() > 0);
+	} //-V773
+	else
+	{
+		// no need to manage callbacks
+		for (const TSharedRef<FChunk>& Chunk : ChunksToDownload)
+		{
+			DownloadChunkInternal(*Chunk, FCallback(), Priority, DownloadClass);
+		}
+	}
+#endif
+
+	// resave manifest if needed
+	SaveLocalManifest(false);
+	ComputeLoadingStats();
+}
+
+void FChunkDownloaderCustom::MountChunk(int32 ChunkId, const FCallback& Callback, bool bPreScanAssets)
+{
+	// learn from it, even if it's mounted already
+	const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+	if (ChunkPtr != nullptr && (*ChunkPtr)->PakFiles.Num() > 0)
+	{
+		RecordChunkAccess(MakeArrayView(&ChunkId, 1));
+	}
+	MountChunkById(ChunkId, Callback, bPreScanAssets);
+}
+
+void FChunkDownloaderCustom::MountChunkById(int32 ChunkId, const FCallback& Callback, bool bPreScanAssets)
+{
+	// look up the chunk
+	TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+	if (ChunkPtr == nullptr || (*ChunkPtr)->PakFiles.Num() <= 0)
+	{
+		// a chunk that doesn't exist or one with no pak files are both considered "complete" for the purposes of this call
+		// use GetChunkStatus to differentiate from chunks that mounted successfully
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring mount request for chunk %d (no mapped pak files)."), ChunkId);
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+	FChunk& Chunk = **ChunkPtr;
+
+	// see if we're mounted already (and staying that way)
+	if (Chunk.bIsMounted && Chunk.MountTask == nullptr)
+	{
+		// trivial success
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	// mount the chunk
+	MountChunkInternal(Chunk, bPreScanAssets, Callback);
+
+	// resave manifest if needed
+	SaveLocalManifest(false);
+	ComputeLoadingStats();
+}
+
+void FChunkDownloaderCustom::MountChunk(int32 ChunkId, const FTimespan& Deadline, const FCallback& Callback, bool bPreScanAssets)
+{
+	// deadlines need to be known before the requests are queued
+	if (const TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId))
+	{
+		SetChunkDeadline(**ChunkPtr, FDateTime::UtcNow() + Deadline);
+	}
+	MountChunk(ChunkId, Callback, bPreScanAssets);
+
+	// warn right away if it's already hopeless
+	CheckDeadlines();
+}
+
+void FChunkDownloaderCustom::MountChunks(const TArray<int32>& ChunkIds, const FCallback& Callback, bool bPreScanAssets, bool bBatch)
+{
+	// convert to chunk references
+	TArray<TSharedRef<FChunk>> ChunksToMount;
+	TArray<int32> AccessedChunkIds;
+	for (int32 ChunkId : ChunkIds)
+	{
+		TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+		if (ChunkPtr != nullptr)
+		{
+			TSharedRef<FChunk>& ChunkRef = *ChunkPtr;
+			if (ChunkRef->PakFiles.Num() > 0)
+			{
+				AccessedChunkIds.AddUnique(ChunkId);
+				if (!ChunkRef->bIsMounted || ChunkRef->MountTask != nullptr)
+				{
+					ChunksToMount.Add(ChunkRef);
+				}
+				continue;
+			}
+		}
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring mount request for chunk %d (no mapped pak files)."), ChunkId);
+	}
+
+	RecordChunkAccess(AccessedChunkIds);
+
+	// make sure there are some chunks to mount (saves a frame)
+	if (ChunksToMount.Num() <= 0)
+	{
+		// trivial success
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	// chunks that can mount right away are mounted together, the rest go through the regular path (downloads, verification...)
+	TSharedPtr<FMountBatch> Batch;
+	if (bBatch)
+	{
+		Batch = MakeShared<FMountBatch>();
+	}
+
+	// if there's no callback for some reason, avoid a bunch of boilerplate
+#ifndef PVS_STUDIO // Build machine refuses to disable this warning
+	if (Callback)
+	{
+		// loop over chunks and issue individual callback
+		FMultiCallback* MultiCallback = new FMultiCallback(Callback);
+		for (const TSharedRef<FChunk>& Chunk : ChunksToMount)
+		{
+			if (Batch.IsValid() && IsReadyToMount(*Chunk))
+			{
+				CreateMountTask(*Chunk, bPreScanAssets, MultiCallback->AddPending(), Batch);
+				continue;
+			}
+			MountChunkInternal(*Chunk, bPreScanAssets, MultiCallback->AddPending());
+		}
+		check(MultiCallback->GetNumPending() > 0);
+	} //-V773
+	else
+	{
+		// no need to manage callbacks
+		for (const TSharedRef<FChunk>& Chunk : ChunksToMount)
+		{
+			if (Batch.IsValid() && IsReadyToMount(*Chunk))
+			{
+				CreateMountTask(*Chunk, bPreScanAssets, FCallback(), Batch);
+				continue;
+			}
+			MountChunkInternal(*Chunk, bPreScanAssets, FCallback());
+		}
+	}
+#endif
+
+	// resave manifest if needed
+	SaveLocalManifest(false);
+	ComputeLoadingStats();
+}
+
+void FChunkDownloaderCustom::UnmountChunk(int32 ChunkId, const FCallback& Callback)
+{
+	// look up the chunk
+	TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+	if (ChunkPtr == nullptr || (*ChunkPtr)->PakFiles.Num() <= 0)
+	{
+		// a chunk that doesn't exist or one with no pak files are both considered "complete" for the purposes of this call
+		// use GetChunkStatus to differentiate from chunks that mounted successfully
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring mount request for chunk %d (no mapped pak files)."), ChunkId);
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+	FChunk& Chunk = **ChunkPtr;
+
+	// mounts still waiting on downloads shouldn't go through anymore
+	++Chunk.UnmountSerial;
+
+	// see if we're unmounted already (and staying that way)
+	if (!Chunk.bIsMounted && Chunk.MountTask == nullptr)
+	{
+		// trivial success
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	// mount the chunk
+	UnmountChunkInternal(Chunk, Callback);
+
+	// resave manifest if needed
+	SaveLocalManifest(false);
+	ComputeLoadingStats();
+}
+
+void FChunkDownloaderCustom::UnmountChunks(const TArray<int32>& ChunkIds, const FCallback& Callback)
+{
+	// convert to chunk references
+	TArray<TSharedRef<FChunk>> ChunksToUnmount;
+	for (int32 ChunkId : ChunkIds)
+	{
+		TSharedRef<FChunk>* ChunkPtr = Chunks.Find(ChunkId);
+		if (ChunkPtr != nullptr)
+		{
+			TSharedRef<FChunk>& ChunkRef = *ChunkPtr;
+			if (ChunkRef->PakFiles.Num() > 0)
+			{
+				// mounts still waiting on downloads shouldn't go through anymore
+				++ChunkRef->UnmountSerial;
+				if (ChunkRef->bIsMounted || ChunkRef->MountTask != nullptr)
+				{
+					ChunksToUnmount.Add(ChunkRef);
+				}
+				continue;
+			}
+		}
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Ignoring unmmount request for chunk %d (no mapped pak files)."), ChunkId);
+	}
+
+	// make sure there are some chunks to mount (saves a frame)
+	if (ChunksToUnmount.Num() <= 0)
+	{
+		// trivial success
+		ExecuteNextTick(Callback, true);
+		return;
+	}
+
+	// if there's no callback for some reason, avoid a bunch of boilerplate
+#ifndef PVS_STUDIO // Build machine refuses to disable this warning
+	if (Callback)
+	{
+		// loop over chunks and issue individual callback
+		FMultiCallback* MultiCallback = new FMultiCallback(Callback);
+		for (const TSharedRef<FChunk>& Chunk : ChunksToUnmount)
+		{
+			UnmountChunkInternal(*Chunk, MultiCallback->AddPending());
+		}
+		check(MultiCallback->GetNumPending() > 0);
+	} //-V773
+	else
+	{
+		// no need to manage callbacks
+		for (const TSharedRef<FChunk>& Chunk : ChunksToUnmount)
+		{
+			UnmountChunkInternal(*Chunk, FCallback());
+		}
+	}
+#endif
+
+	// resave manifest if needed
+	SaveLocalManifest(false);
+	ComputeLoadingStats();
+}
+
+
+
+#undef LOCTEXT_NAMESPACE
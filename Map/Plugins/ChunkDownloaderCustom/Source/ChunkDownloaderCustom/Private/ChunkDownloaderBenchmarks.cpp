@@ -0,0 +1,405 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ChunkDownloader.h"
+#include "ChunkDownloaderLog.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "IPlatformFilePak.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if !UE_BUILD_SHIPPING
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Mount toggling
+
+static void BenchmarkMountToggle(const TArray<FString>& Args)
+{
+	TSharedPtr<FChunkDownloaderCustom> ChunkDownloader = FChunkDownloaderCustom::Get();
+	if (!ChunkDownloader.IsValid() || Args.Num() < 1)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Usage: ChunkDownloader.Benchmark.MountToggle <ChunkId> [Iterations=100] (chunk should already be cached)"));
+		return;
+	}
+
+	int32 ChunkId = FCString::Atoi(*Args[0]);
+	int32 NumIterations = (Args.Num() > 1) ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 100;
+	if (ChunkDownloader->GetChunkStatus(ChunkId) != EChunkStatus::Cached && ChunkDownloader->GetChunkStatus(ChunkId) != EChunkStatus::Mounted)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Chunk %d is not cached locally, the benchmark will include downloads."), ChunkId);
+	}
+
+	struct FToggleResults
+	{
+		int32 NumPending = 0;
+		int32 NumSucceeded = 0;
+		int32 NumFailed = 0;
+		uint32 FirstTaskId = 0;
+		double StartTime = 0.0;
+	};
+	TSharedRef<FToggleResults> Results = MakeShared<FToggleResults>();
+	Results->NumPending = NumIterations;
+	Results->FirstTaskId = ChunkDownloader->GetNumMountTasksStarted();
+	Results->StartTime = FPlatformTime::Seconds();
+
+	// alternate mount and unmount requests within the same frame (like walking back and forth across a trigger)
+	TWeakPtr<FChunkDownloaderCustom> WeakDownloader = ChunkDownloader;
+	bool bMount = (ChunkDownloader->GetChunkStatus(ChunkId) != EChunkStatus::Mounted);
+	for (int32 i = 0; i < NumIterations; ++i, bMount = !bMount)
+	{
+		FChunkDownloaderCustom::FCallback Callback = [Results, WeakDownloader, ChunkId, NumIterations](bool bSuccess) {
+			++(bSuccess ? Results->NumSucceeded : Results->NumFailed);
+			if (--Results->NumPending > 0)
+			{
+				return;
+			}
+
+			TSharedPtr<FChunkDownloaderCustom> SharedDownloader = WeakDownloader.Pin();
+			if (SharedDownloader.IsValid())
+			{
+				UE_LOG(LogChunkDownloaderCustom, Display, TEXT("MountToggle chunk %d: %d requests settled in %.2f ms, %u mount tasks ran, %d succeeded, %d superseded/failed, final status %s."),
+					ChunkId, NumIterations, (FPlatformTime::Seconds() - Results->StartTime) * 1000.0,
+					SharedDownloader->GetNumMountTasksStarted() - Results->FirstTaskId, Results->NumSucceeded, Results->NumFailed,
+					FChunkDownloaderCustom::ChunkStatusToString(SharedDownloader->GetChunkStatus(ChunkId)));
+			}
+		};
+
+		if (bMount)
+		{
+			ChunkDownloader->MountChunk(ChunkId, Callback);
+		}
+		else
+		{
+			ChunkDownloader->UnmountChunk(ChunkId, Callback);
+		}
+	}
+}
+
+static FAutoConsoleCommand CmdBenchmarkMountToggle(
+	TEXT("ChunkDownloader.Benchmark.MountToggle"),
+	TEXT("Alternate mount/unmount requests for a chunk and report how long they take to settle and how many mount tasks actually ran. Usage: ChunkDownloader.Benchmark.MountToggle <ChunkId> [Iterations=100]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkMountToggle));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Asset registry population
+
+static void BenchmarkAssetRegistry(const TArray<FString>& Args)
+{
+	TSharedPtr<FChunkDownloaderCustom> ChunkDownloader = FChunkDownloaderCustom::Get();
+	if (!ChunkDownloader.IsValid() || Args.Num() < 1)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Usage: ChunkDownloader.Benchmark.AssetRegistry <ChunkId> (chunk should already be mounted)"));
+		return;
+	}
+
+	int32 ChunkId = FCString::Atoi(*Args[0]);
+	if (ChunkDownloader->GetChunkStatus(ChunkId) != EChunkStatus::Mounted)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Chunk %d is not mounted."), ChunkId);
+		return;
+	}
+
+	// run the fragment path first, the file scan would otherwise find everything already known
+	// (the second pass still reads every package, which is the part being measured)
+	double StartTime = FPlatformTime::Seconds();
+	int32 NumFromFragment = ChunkDownloader->ScanAssetsInChunks({ ChunkId }, true);
+	double FragmentTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	int32 NumFromScan = ChunkDownloader->ScanAssetsInChunks({ ChunkId }, false);
+	double ScanTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("AssetRegistry chunk %d: fragment merge %.2f ms (%d assets), synchronous scan %.2f ms (%d assets)."),
+		ChunkId, FragmentTime * 1000.0, NumFromFragment, ScanTime * 1000.0, NumFromScan);
+}
+
+static FAutoConsoleCommand CmdBenchmarkAssetRegistry(
+	TEXT("ChunkDownloader.Benchmark.AssetRegistry"),
+	TEXT("Time merging a mounted chunk's serialized asset registry against scanning its files synchronously. Usage: ChunkDownloader.Benchmark.AssetRegistry <ChunkId>"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkAssetRegistry));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loose package lookups
+
+static void BenchmarkContentLookup(const TArray<FString>& Args)
+{
+	int32 NumFiles = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+	int32 NumLookups = (Args.Num() > 1) ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+
+	// synthetic chunk: a cooked asset and its .uexp per package, spread over a few folders with recurring leaf names
+	double StartTime = FPlatformTime::Seconds();
+	FChunkDownloaderCustom::FContentIndex Index;
+	Index.Files.Reserve(NumFiles);
+	for (int32 i = 0; i < NumFiles; ++i)
+	{
+		Index.AddFile(FString::Printf(TEXT("/Game/Benchmark/Folder%d/Asset%d.%s"), (i / 2) % 97, (i / 2) % 5003, (i % 2) ? TEXT("uexp") : TEXT("uasset")));
+	}
+	double BuildTime = FPlatformTime::Seconds() - StartTime;
+
+	TArray<FString> Queries;
+	for (int32 i = 0; i < NumLookups; ++i)
+	{
+		int32 Package = FMath::RandRange(0, NumFiles / 2);
+		Queries.Add(FString::Printf(TEXT("Folder%d/Asset%d"), Package % 97, Package % 5003));
+	}
+
+	// what GetChunkContent used to do: split every package name into segments and compare them from the end
+	StartTime = FPlatformTime::Seconds();
+	int32 NumFoundScanning = 0;
+	for (const FString& Query : Queries)
+	{
+		TArray<FString> QuerySegments;
+		Query.ParseIntoArray(QuerySegments, TEXT("/"));
+		for (const FChunkDownloaderCustom::FChunkFile& File : Index.Files)
+		{
+			if (!File.IsCooked())
+			{
+				continue;
+			}
+			TArray<FString> TestStr1 = QuerySegments;
+			TArray<FString> TestStr2;
+			File.PackageName.ToString().ParseIntoArray(TestStr2, TEXT("/"));
+			bool bMatch = TestStr1.Num() <= TestStr2.Num();
+			while (bMatch && TestStr1.Num() > 0)
+			{
+				bMatch = TestStr1.Pop().Equals(TestStr2.Pop());
+			}
+			if (bMatch)
+			{
+				++NumFoundScanning;
+				break;
+			}
+		}
+	}
+	double ScanTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	int32 NumFoundIndexed = 0;
+	for (const FString& Query : Queries)
+	{
+		NumFoundIndexed += (Index.FindPackage(Query) != nullptr) ? 1 : 0;
+	}
+	double IndexedTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("ContentLookup: %d files indexed in %.2f ms. %d lookups: segment scan %.2f ms (%d found), leaf name index %.3f ms (%d found)."),
+		NumFiles, BuildTime * 1000.0, NumLookups, ScanTime * 1000.0, NumFoundScanning, IndexedTime * 1000.0, NumFoundIndexed);
+}
+
+static FAutoConsoleCommand CmdBenchmarkContentLookup(
+	TEXT("ChunkDownloader.Benchmark.ContentLookup"),
+	TEXT("Compare loose package name lookups through the content index against the old segment-by-segment scan, on a synthetic chunk. Usage: ChunkDownloader.Benchmark.ContentLookup [NumFiles=100000] [NumLookups=1000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkContentLookup));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Page cache prewarming
+
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+// drop every mounted pak file from the page cache so the next reads are cold
+static void EvictMountedPaks()
+{
+	FPakPlatformFile* PakPlatformFile = (FPakPlatformFile*)FPlatformFileManager::Get().FindPlatformFile(FPakPlatformFile::GetTypeName());
+	if (PakPlatformFile == nullptr)
+	{
+		return;
+	}
+
+	TArray<FString> PakFilenames;
+	PakPlatformFile->GetMountedPakFilenames(PakFilenames);
+	for (const FString& PakFilename : PakFilenames)
+	{
+		int Fd = open(TCHAR_TO_UTF8(*IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*PakFilename)), O_RDONLY);
+		if (Fd >= 0)
+		{
+			posix_fadvise(Fd, 0, 0, POSIX_FADV_DONTNEED);
+			close(Fd);
+		}
+	}
+}
+#endif
+
+// read every file of the selected packages (all of them if Packages is empty) through the pak platform file, like loading them would, minus the deserialization
+static int64 ReadChunkFiles(const FChunkDownloaderCustom& ChunkDownloader, int32 ChunkId, const TSet<FName>& Packages)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TArray<uint8> Buffer;
+	int64 BytesRead = 0;
+	ChunkDownloader.ForEachChunkFile(ChunkId, [&PlatformFile, &Buffer, &BytesRead, &Packages](const FChunkDownloaderCustom::FChunkFile& File)
+	{
+		FString Filename;
+		if ((Packages.Num() > 0 && !Packages.Contains(File.PackageName)) || !FPackageName::TryConvertLongPackageNameToFilename(File.PackageName.ToString(), Filename, FPaths::GetExtension(File.Path, true)))
+		{
+			return true;
+		}
+
+		IFileHandle* FilePtr = PlatformFile.OpenRead(*Filename);
+		if (FilePtr != nullptr)
+		{
+			Buffer.SetNumUninitialized(FilePtr->Size());
+			if (FilePtr->Read(Buffer.GetData(), Buffer.Num()))
+			{
+				BytesRead += Buffer.Num();
+			}
+			delete FilePtr;
+		}
+		return true;
+	}, false);
+	return BytesRead;
+}
+
+static void BenchmarkPrewarm(const TArray<FString>& Args)
+{
+	TSharedPtr<FChunkDownloaderCustom> ChunkDownloader = FChunkDownloaderCustom::Get();
+	if (!ChunkDownloader.IsValid() || Args.Num() < 1)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Usage: ChunkDownloader.Benchmark.Prewarm <ChunkId> [PackageName...] (chunk should already be mounted)"));
+		return;
+	}
+
+	int32 ChunkId = FCString::Atoi(*Args[0]);
+	if (ChunkDownloader->GetChunkStatus(ChunkId) != EChunkStatus::Mounted)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Chunk %d is not mounted."), ChunkId);
+		return;
+	}
+
+	TArray<FName> PackageNames;
+	for (int32 i = 1; i < Args.Num(); ++i)
+	{
+		PackageNames.Add(FName(*Args[i]));
+	}
+	TSet<FName> PackageSet(PackageNames);
+
+	// cold reads
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+	EvictMountedPaks();
+#else
+	UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("Can't evict pak files from the OS file cache on this platform, the cold pass may already be warm."));
+#endif
+	double StartTime = FPlatformTime::Seconds();
+	int64 BytesRead = ReadChunkFiles(*ChunkDownloader, ChunkId, PackageSet);
+	double ColdTime = FPlatformTime::Seconds() - StartTime;
+
+	// prewarm from cold, then read again
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+	EvictMountedPaks();
+#endif
+	StartTime = FPlatformTime::Seconds();
+	TWeakPtr<FChunkDownloaderCustom> WeakDownloader = ChunkDownloader;
+	ChunkDownloader->PrewarmChunk(ChunkId, PackageNames, [WeakDownloader, ChunkId, PackageSet, BytesRead, ColdTime, StartTime](int64 BytesWarmed, int64 BytesAdvised) {
+		double PrewarmTime = FPlatformTime::Seconds() - StartTime;
+		TSharedPtr<FChunkDownloaderCustom> SharedDownloader = WeakDownloader.Pin();
+		if (!SharedDownloader.IsValid())
+		{
+			return;
+		}
+
+		double WarmStartTime = FPlatformTime::Seconds();
+		ReadChunkFiles(*SharedDownloader, ChunkId, PackageSet);
+		double WarmTime = FPlatformTime::Seconds() - WarmStartTime;
+
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Prewarm chunk %d: %lld bytes read and %lld bytes advised in %.2f ms. Reading %lld bytes of package files: %.2f ms cold, %.2f ms after prewarming (%.2f ms saved)."),
+			ChunkId, BytesWarmed, BytesAdvised, PrewarmTime * 1000.0, BytesRead, ColdTime * 1000.0, WarmTime * 1000.0, (ColdTime - WarmTime) * 1000.0);
+	});
+}
+
+static FAutoConsoleCommand CmdBenchmarkPrewarm(
+	TEXT("ChunkDownloader.Benchmark.Prewarm"),
+	TEXT("Compare reading a mounted chunk's package files from a cold OS file cache against reading them after PrewarmChunk. Usage: ChunkDownloader.Benchmark.Prewarm <ChunkId> [PackageName...]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkPrewarm));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sampled pak verification
+
+static void TestPakSamples(const TArray<FString>& Args)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Usage: ChunkDownloader.Test.PakSamples <PakFile>"));
+		return;
+	}
+
+	// open it on its own, the way the mount task samples it
+	const FString& PakPath = Args[0];
+	FPakPlatformFile* PakPlatformFile = (FPakPlatformFile*)FPlatformFileManager::Get().FindPlatformFile(FPakPlatformFile::GetTypeName());
+	IPlatformFile* LowerLevel = (PakPlatformFile != nullptr) ? PakPlatformFile->GetLowerLevel() : &IPlatformFile::GetPlatformPhysical();
+	TRefCountPtr<FPakFile> Pak = new FPakFile(LowerLevel, *PakPath, false);
+	if (!Pak->IsValid())
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("PakSamples: unable to open %s."), *PakPath);
+		return;
+	}
+
+	// the cases the hashes have to be found for: encoded indexes don't keep them, compressed and encrypted entries are stored differently
+	int32 NumFiles = 0, NumCompressed = 0, NumEncrypted = 0;
+	for (FPakFile::FFilenameIterator File(*Pak); File; ++File)
+	{
+		++NumFiles;
+		NumCompressed += (File.Info().CompressionMethodIndex != 0) ? 1 : 0;
+		NumEncrypted += File.Info().IsEncrypted() ? 1 : 0;
+	}
+	const bool bEncodedIndex = Pak->GetInfo().Version >= FPakInfo::PakFile_Version_PathHashIndex;
+
+	// every file (up to the sampling size limit)
+	const bool bPassed = FChunkDownloaderCustom::CheckPakFileSamples(*Pak, PakPath, Pak->TotalSize(), NumFiles);
+	UE_LOG(LogChunkDownloaderCustom, Display, TEXT("PakSamples %s: %s index, %d files (%d compressed, %d encrypted). %s"),
+		*PakPath, bEncodedIndex ? TEXT("encoded") : TEXT("legacy"), NumFiles, NumCompressed, NumEncrypted, bPassed ? TEXT("PASSED") : TEXT("FAILED"));
+}
+
+static FAutoConsoleCommand CmdTestPakSamples(
+	TEXT("ChunkDownloader.Test.PakSamples"),
+	TEXT("Run the lazy mount verification sampling over every file of a pak (e.g. a compressed pak with an encoded index) and report whether they all match. Usage: ChunkDownloader.Test.PakSamples <PakFile>"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&TestPakSamples));
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cross-chunk dependency closure
+
+static void TestChunkClosure(const TArray<FString>& Args)
+{
+	if (Args.Num() < 2)
+	{
+		UE_LOG(LogChunkDownloaderCustom, Display, TEXT("Usage: ChunkDownloader.Test.ChunkClosure <PackageName> <DependencyChunkId>"));
+		return;
+	}
+
+	// a package in one chunk that hard depends on a package in another one, both unmounted so only the registry fragments know the dependency
+	const FName PackageName(*Args[0]);
+	const int32 DependencyChunkId = FCString::Atoi(*Args[1]);
+	TSharedRef<FChunkDownloaderCustom> ChunkDownloader = FChunkDownloaderCustom::GetChecked();
+	TArray<int32> PackageChunkIds;
+	if (!ChunkDownloader->GetChunksForPackage(PackageName, PackageChunkIds) || PackageChunkIds.Contains(DependencyChunkId))
+	{
+		UE_LOG(LogChunkDownloaderCustom, Error, TEXT("ChunkClosure: %s has to be in a known chunk other than %d."), *PackageName.ToString(), DependencyChunkId);
+		return;
+	}
+	for (int32 ChunkId : PackageChunkIds)
+	{
+		if (ChunkDownloader->GetChunkStatus(ChunkId) == EChunkStatus::Mounted)
+		{
+			UE_LOG(LogChunkDownloaderCustom, Warning, TEXT("ChunkClosure: chunk %d is mounted, the asset registry may supply the dependency instead of its fragment."), ChunkId);
+		}
+	}
+
+	ChunkDownloader->ResolveChunkClosure(PackageName, [PackageName, PackageChunkIds, DependencyChunkId](bool bSuccess, const TArray<int32>& ChunkIds)
+		{
+			bool bPassed = bSuccess && ChunkIds.Contains(DependencyChunkId);
+			for (int32 ChunkId : PackageChunkIds)
+			{
+				bPassed &= ChunkIds.Contains(ChunkId);
+			}
+			FString ChunkList = FString::JoinBy(ChunkIds, TEXT(","), [](int32 ChunkId) { return FString::FromInt(ChunkId); });
+			UE_LOG(LogChunkDownloaderCustom, Display, TEXT("ChunkClosure %s: chunks [%s], expected %d. %s"),
+				*PackageName.ToString(), *ChunkList, DependencyChunkId, bPassed ? TEXT("PASSED") : TEXT("FAILED"));
+		});
+}
+
+static FAutoConsoleCommand CmdTestChunkClosure(
+	TEXT("ChunkDownloader.Test.ChunkClosure"),
+	TEXT("Resolve the chunk closure of a package that hard depends on content of another chunk and check that the other chunk is part of it. Usage: ChunkDownloader.Test.ChunkClosure <PackageName> <DependencyChunkId>"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&TestChunkClosure));
+
+#endif // !UE_BUILD_SHIPPING
@@ -90,18 +90,18 @@ UCDL_UnmountChunk_AsyncAction* UCDL_UnmountChunk_AsyncAction::UnmountChunk(FLate
 	return nullptr;
 }
 
-UCDL_MountChunks_AsyncAction* UCDL_MountChunks_AsyncAction::MountChunks(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, const TArray<int32>& ChunkIds, bool bPreScanAssets)
+UCDL_MountChunks_AsyncAction* UCDL_MountChunks_AsyncAction::MountChunks(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, const TArray<int32>& ChunkIds, bool bPreScanAssets, bool bBatch)
 {
 	if (Target)
 	{
 
 			if (auto Result = ULatentAsyncAction::Create<UCDL_MountChunks_AsyncAction>(Target->GetGameInstance(), LatentInfo.CallbackTarget, LatentInfo.UUID))
 			{
-				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), ChunkIds, bPreScanAssets](const FCallback& Callback)
+				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), ChunkIds, bPreScanAssets, bBatch](const FCallback& Callback)
 					{
 						if (Target.IsValid())
 						{
-							Target->MountChunks(ChunkIds, bPreScanAssets, Callback);
+							Target->MountChunks(ChunkIds, bPreScanAssets, Callback, bBatch);
 							return true;
 						}
 						return false;
@@ -135,18 +135,106 @@ UCDL_MountChunk_AsyncAction* UCDL_MountChunk_AsyncAction::MountChunk(FLatentActi
 	return nullptr;
 }
 
-UCDL_DownloadChunks_AsyncAction* UCDL_DownloadChunks_AsyncAction::DownloadChunks(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, const TArray<int32>& ChunkIds, int32 Priority)
+UCDL_AcquirePackage_AsyncAction* UCDL_AcquirePackage_AsyncAction::AcquirePackage(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, FName PackageName, bool bPreScanAssets)
+{
+	if (Target)
+	{
+			if (auto Result = ULatentAsyncAction::Create<UCDL_AcquirePackage_AsyncAction>(Target->GetGameInstance(), LatentInfo.CallbackTarget, LatentInfo.UUID))
+			{
+				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), PackageName, bPreScanAssets](const FCallback& Callback)
+					{
+						if (Target.IsValid())
+						{
+							Target->AcquirePackage(PackageName, bPreScanAssets, Callback);
+							return true;
+						}
+						return false;
+					});
+				return Result;
+			}
+		
+	}
+	return nullptr;
+}
+
+UCDL_PrewarmChunk_AsyncAction* UCDL_PrewarmChunk_AsyncAction::PrewarmChunk(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, int32 ChunkId, const TArray<FName>& PackageNames)
+{
+	if (Target)
+	{
+			if (auto Result = ULatentAsyncAction::Create<UCDL_PrewarmChunk_AsyncAction>(Target->GetGameInstance(), LatentInfo.CallbackTarget, LatentInfo.UUID))
+			{
+				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), ChunkId, PackageNames](const FCallback& Callback)
+					{
+						if (Target.IsValid())
+						{
+							Target->PrewarmChunk(ChunkId, PackageNames, Callback);
+							return true;
+						}
+						return false;
+					});
+				return Result;
+			}
+		
+	}
+	return nullptr;
+}
+
+UCDL_PrepareLevel_AsyncAction* UCDL_PrepareLevel_AsyncAction::PrepareLevel(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, TSoftObjectPtr<UWorld> Level, bool bPreScanAssets)
+{
+	if (Target)
+	{
+			if (auto Result = ULatentAsyncAction::Create<UCDL_PrepareLevel_AsyncAction>(Target->GetGameInstance(), LatentInfo.CallbackTarget, LatentInfo.UUID))
+			{
+				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), Level, bPreScanAssets](const FCallback& Callback)
+					{
+						if (Target.IsValid())
+						{
+							Target->PrepareLevel(Level, bPreScanAssets, Callback);
+							return true;
+						}
+						return false;
+					});
+				return Result;
+			}
+		
+	}
+	return nullptr;
+}
+
+UCDL_ScanAssetsInChunks_AsyncAction* UCDL_ScanAssetsInChunks_AsyncAction::ScanAssetsInChunks(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, const TArray<int32>& ChunkIds)
+{
+	if (Target)
+	{
+			if (auto Result = ULatentAsyncAction::Create<UCDL_ScanAssetsInChunks_AsyncAction>(Target->GetGameInstance(), LatentInfo.CallbackTarget, LatentInfo.UUID))
+			{
+				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), ChunkIds](const FCallback& Callback)
+					{
+						if (Target.IsValid())
+						{
+							Target->ScanAssetsInChunksAsync(ChunkIds, Callback);
+							return true;
+						}
+						return false;
+					});
+				return Result;
+			}
+		
+	}
+	return nullptr;
+}
+
+UCDL_DownloadChunks_AsyncAction* UCDL_DownloadChunks_AsyncAction::DownloadChunks(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, const TArray<int32>& ChunkIds, int32 Priority, FName DownloadClass)
 {
 	if (Target)
 	{
 
 			if (auto Result = ULatentAsyncAction::Create<UCDL_DownloadChunks_AsyncAction>(Target->GetGameInstance(), LatentInfo.CallbackTarget, LatentInfo.UUID))
 			{
-				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), ChunkIds, Priority](const FCallback& Callback)
+				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), ChunkIds, Priority, DownloadClass](const FCallback& Callback)
 					{
 						if (Target.IsValid())
 						{
-							Target->DownloadChunks(ChunkIds, Callback, Priority);
+							Target->DownloadChunks(ChunkIds, Callback, Priority, DownloadClass);
 							return true;
 						}
 						return false;
@@ -158,18 +246,18 @@ UCDL_DownloadChunks_AsyncAction* UCDL_DownloadChunks_AsyncAction::DownloadChunks
 	return nullptr;
 }
 
-UCDL_DownloadChunk_AsyncAction* UCDL_DownloadChunk_AsyncAction::DownloadChunk(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, int32 ChunkId, int32 Priority)
+UCDL_DownloadChunk_AsyncAction* UCDL_DownloadChunk_AsyncAction::DownloadChunk(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target, int32 ChunkId, int32 Priority, FName DownloadClass)
 {
 	if (Target)
 	{
 
 			if (auto Result = ULatentAsyncAction::Create<UCDL_DownloadChunk_AsyncAction>(Target->GetGameInstance(), LatentInfo.CallbackTarget, LatentInfo.UUID))
 			{
-				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), ChunkId, Priority](const FCallback& Callback)
+				Result->Function = FFunction([Target = TWeakObjectPtr<UChunkDownloaderSubsystem>(Target), ChunkId, Priority, DownloadClass](const FCallback& Callback)
 					{
 						if (Target.IsValid())
 						{
-							Target->DownloadChunk(ChunkId, Callback, Priority);
+							Target->DownloadChunk(ChunkId, Callback, Priority, DownloadClass);
 							return true;
 						}
 						return false;
@@ -0,0 +1,146 @@
+#include "ChunkPrefetchComponent.h"
+#include "ChunkDownloaderSubsystem.h"
+#include "ChunkDownloaderLog.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+
+UChunkPrefetchComponent::UChunkPrefetchComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+}
+
+void UChunkPrefetchComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SetComponentTickInterval(UpdateInterval);
+	PrefetchChunkIds = ChunkIds;
+}
+
+void UChunkPrefetchComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// the pawn can change (respawn, possession), so look it up every time
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (PlayerPawn == nullptr || GetChunkDownloader() == nullptr)
+	{
+		return;
+	}
+
+	// outer rings first, so a player spawning inside the mount ring still goes through every stage
+	const float DistSquared = FVector::DistSquared(PlayerPawn->GetActorLocation(), GetComponentLocation());
+	if (Stage == EChunkPrefetchStage::Idle && DistSquared <= FMath::Square(DownloadRadius))
+	{
+		SetStage(EChunkPrefetchStage::Downloading);
+		StartDownload(BackgroundPriority);
+	}
+	if (Stage == EChunkPrefetchStage::Downloading && DistSquared <= FMath::Square(PriorityRadius))
+	{
+		SetStage(EChunkPrefetchStage::Prioritized);
+		StartDownload(UrgentPriority);
+	}
+	if (Stage == EChunkPrefetchStage::Prioritized && DistSquared <= FMath::Square(MountRadius))
+	{
+		SetStage(EChunkPrefetchStage::Mounting);
+		StartMount();
+	}
+}
+
+void UChunkPrefetchComponent::ResetStage()
+{
+	SetStage(EChunkPrefetchStage::Idle);
+}
+
+void UChunkPrefetchComponent::SetStage(EChunkPrefetchStage NewStage)
+{
+	if (Stage == NewStage)
+	{
+		return;
+	}
+	Stage = NewStage;
+
+	// nothing left to do until the stage is reset
+	SetComponentTickEnabled(Stage < EChunkPrefetchStage::Mounting);
+
+	UE_LOG(LogChunkDownloaderCustom, Verbose, TEXT("Chunk prefetch %s entered stage %d."), *GetPathName(), (int32)Stage);
+	OnStageChanged.Broadcast(Stage);
+}
+
+void UChunkPrefetchComponent::StartDownload(int32 Priority)
+{
+	UChunkDownloaderSubsystem* ChunkDownloader = GetChunkDownloader();
+	if (!Level.IsNull() && Stage == EChunkPrefetchStage::Downloading)
+	{
+		// find out what the level needs first, then catch up with the current stage
+		TWeakObjectPtr<UChunkPrefetchComponent> WeakThis(this);
+		ChunkDownloader->ResolveChunkClosure(Level.ToSoftObjectPath().GetLongPackageFName(), [WeakThis](bool bSuccess, const TArray<int32>& ClosureChunkIds)
+			{
+				UChunkPrefetchComponent* This = WeakThis.Get();
+				if (This == nullptr || !bSuccess)
+				{
+					return;
+				}
+
+				for (int32 ChunkId : ClosureChunkIds)
+				{
+					This->PrefetchChunkIds.AddUnique(ChunkId);
+				}
+				if (This->Stage == EChunkPrefetchStage::Downloading || This->Stage == EChunkPrefetchStage::Prioritized)
+				{
+					This->GetChunkDownloader()->DownloadChunks(This->PrefetchChunkIds, UChunkDownloaderSubsystem::FCallback(),
+						This->Stage == EChunkPrefetchStage::Prioritized ? This->UrgentPriority : This->BackgroundPriority, This->DownloadClass);
+				}
+			});
+	}
+
+	// requesting chunks already on their way only raises their priority
+	if (PrefetchChunkIds.Num() > 0)
+	{
+		ChunkDownloader->DownloadChunks(PrefetchChunkIds, UChunkDownloaderSubsystem::FCallback(), Priority, DownloadClass);
+	}
+}
+
+void UChunkPrefetchComponent::StartMount()
+{
+	TWeakObjectPtr<UChunkPrefetchComponent> WeakThis(this);
+	UChunkDownloaderSubsystem::FCallback OnMounted = [WeakThis](bool bSuccess)
+	{
+		if (UChunkPrefetchComponent* This = WeakThis.Get())
+		{
+			if (This->Stage == EChunkPrefetchStage::Mounting)
+			{
+				This->SetStage(bSuccess ? EChunkPrefetchStage::Ready : EChunkPrefetchStage::Failed);
+			}
+		}
+	};
+
+	// the level closure can still be resolving, PrepareLevel takes care of it anyway
+	UChunkDownloaderSubsystem* ChunkDownloader = GetChunkDownloader();
+	if (!Level.IsNull() && bPrepareLevel)
+	{
+		ChunkDownloader->MountChunks(ChunkIds, bPreScanAssets, [WeakThis, OnMounted](bool bSuccess)
+			{
+				UChunkPrefetchComponent* This = WeakThis.Get();
+				if (This == nullptr || !bSuccess)
+				{
+					OnMounted(false);
+					return;
+				}
+				This->GetChunkDownloader()->PrepareLevel(This->Level, This->bPreScanAssets, OnMounted);
+			});
+	}
+	else
+	{
+		ChunkDownloader->MountChunks(PrefetchChunkIds, bPreScanAssets, OnMounted);
+	}
+}
+
+UChunkDownloaderSubsystem* UChunkPrefetchComponent::GetChunkDownloader() const
+{
+	UGameInstance* GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UChunkDownloaderSubsystem>() : nullptr;
+}
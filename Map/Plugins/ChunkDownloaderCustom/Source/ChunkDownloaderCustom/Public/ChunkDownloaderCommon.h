@@ -62,6 +62,44 @@ enum class EChunkStatus : uint8
 	Unknown, // no paks are included in this chunk, can consider it either an error or fully mounted depending
 };
 
+USTRUCT(BlueprintType, meta = (
+	HasNativeBreak = "ChunkDownloaderCustom.ChunkDownloaderCommonUtils.BreakChunkStatusInfo",
+	HasNativeMake = "ChunkDownloaderCustom.ChunkDownloaderCommonUtils.MakeChunkStatusInfo"))
+struct CHUNKDOWNLOADERCUSTOM_API FChunkStatusInfo
+{
+	GENERATED_BODY()
+
+	int32 ChunkId = -1;
+	EChunkStatus Status = EChunkStatus::Unknown;
+
+	// size of the pak files in this chunk that are fully cached locally, and of all of them
+	uint64 BytesCached = 0;
+	uint64 BytesTotal = 0;
+};
+
+USTRUCT(BlueprintType, meta = (
+	HasNativeBreak = "ChunkDownloaderCustom.ChunkDownloaderCommonUtils.BreakBackgroundInstallProgress",
+	HasNativeMake = "ChunkDownloaderCustom.ChunkDownloaderCommonUtils.MakeBackgroundInstallProgress"))
+struct CHUNKDOWNLOADERCUSTOM_API FBackgroundInstallProgress
+{
+	GENERATED_BODY()
+
+	// whether the background install is running, and whether it's currently waiting (loading mode, other downloads, disk quota)
+	bool bActive = false;
+	bool bPaused = false;
+
+	// number of chunks that are fully cached locally
+	int32 ChunksCached = 0;
+	int32 TotalChunks = 0;
+
+	// size of the pak files that are fully cached locally
+	uint64 BytesCached = 0;
+	uint64 TotalBytes = 0;
+
+	// based on the current download bandwidth, zero if unknown
+	FTimespan EstimatedTimeRemaining = FTimespan::Zero();
+};
+
 UCLASS()
 class CHUNKDOWNLOADERCUSTOM_API UChunkDownloaderCommonUtils : public UBlueprintFunctionLibrary
 {
@@ -113,6 +151,48 @@ public:
 		Stats.LoadingStartTime = LoadingStartTime;
 		Stats.LastError = LastError;
 	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Utilities|Chunk Status", meta = (CompactNodeTitle = "->"))
+	static void BreakChunkStatusInfo(UPARAM(ref) FChunkStatusInfo& Info, int32& ChunkId, EChunkStatus& Status, FString& BytesCached, FString& BytesTotal)
+	{
+		ChunkId = Info.ChunkId;
+		Status = Info.Status;
+		BytesCached = FString::Printf(TEXT("%llu"), Info.BytesCached);
+		BytesTotal = FString::Printf(TEXT("%llu"), Info.BytesTotal);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Utilities|Chunk Status")
+	static void MakeChunkStatusInfo(FChunkStatusInfo& Info, int32 ChunkId, EChunkStatus Status, FString BytesCached, FString BytesTotal)
+	{
+		Info.ChunkId = ChunkId;
+		Info.Status = Status;
+		Info.BytesCached = FCString::Strtoui64(*BytesCached, NULL, 10);
+		Info.BytesTotal = FCString::Strtoui64(*BytesTotal, NULL, 10);
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Utilities|Background Install Progress", meta = (CompactNodeTitle = "->"))
+	static void BreakBackgroundInstallProgress(UPARAM(ref) FBackgroundInstallProgress& Progress, bool& bActive, bool& bPaused, int32& ChunksCached, int32& TotalChunks, FString& BytesCached, FString& TotalBytes, FTimespan& EstimatedTimeRemaining)
+	{
+		bActive = Progress.bActive;
+		bPaused = Progress.bPaused;
+		ChunksCached = Progress.ChunksCached;
+		TotalChunks = Progress.TotalChunks;
+		BytesCached = FString::Printf(TEXT("%llu"), Progress.BytesCached);
+		TotalBytes = FString::Printf(TEXT("%llu"), Progress.TotalBytes);
+		EstimatedTimeRemaining = Progress.EstimatedTimeRemaining;
+	}
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Utilities|Background Install Progress")
+	static void MakeBackgroundInstallProgress(FBackgroundInstallProgress& Progress, bool bActive, bool bPaused, int32 ChunksCached, int32 TotalChunks, FString BytesCached, FString TotalBytes, FTimespan EstimatedTimeRemaining)
+	{
+		Progress.bActive = bActive;
+		Progress.bPaused = bPaused;
+		Progress.ChunksCached = ChunksCached;
+		Progress.TotalChunks = TotalChunks;
+		Progress.BytesCached = FCString::Strtoui64(*BytesCached, NULL, 10);
+		Progress.TotalBytes = FCString::Strtoui64(*TotalBytes, NULL, 10);
+		Progress.EstimatedTimeRemaining = EstimatedTimeRemaining;
+	}
 };
 
 #if UE_ENABLE_INCLUDE_ORDER_DEPRECATED_IN_5_2
@@ -96,9 +96,10 @@ public:
 
 	// Download and mount all chunks then fire the callback (convenience wrapper managing multiple MountChunk calls)
 	// @param bPreScanAssets	If true, assets contained in the chunk files will be scanned with the Asset Registry after mounting.
-    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AdvancedDisplay="bPreScanAssets"))
+	// @param bBatch			If true, chunks that are ready to mount are mounted together, with mount points registered and assets scanned once for all of them.
+    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AdvancedDisplay="bPreScanAssets,bBatch"))
 	static UCDL_MountChunks_AsyncAction* MountChunks(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target
-		, const TArray<int32>& ChunkIds, bool bPreScanAssets = true
+		, const TArray<int32>& ChunkIds, bool bPreScanAssets = true, bool bBatch = false
 	);
 };
 
@@ -117,6 +118,65 @@ public:
 	);
 };
 
+UCLASS(meta=(DisplayName="Chunk Downloader"))
+class CHUNKDOWNLOADERCUSTOM_API UCDL_AcquirePackage_AsyncAction : public UCDL_AsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+
+	// download (with top priority) and mount the chunks containing a package if they aren't mounted yet.
+	// @param bPreScanAssets	If true, assets contained in the chunk files will be scanned with the Asset Registry after mounting.
+    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AdvancedDisplay = "bPreScanAssets"))
+	static UCDL_AcquirePackage_AsyncAction* AcquirePackage(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target
+		, FName PackageName, bool bPreScanAssets = false
+	);
+};
+
+UCLASS(meta=(DisplayName="Chunk Downloader"))
+class CHUNKDOWNLOADERCUSTOM_API UCDL_PrewarmChunk_AsyncAction : public UCDL_AsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+
+	// read ahead the pak file data of some packages of a mounted chunk (all of them if PackageNames is empty) into the OS file cache, in the background.
+    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AutoCreateRefTerm="PackageNames"))
+	static UCDL_PrewarmChunk_AsyncAction* PrewarmChunk(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target
+		, int32 ChunkId, const TArray<FName>& PackageNames
+	);
+};
+
+UCLASS(meta=(DisplayName="Chunk Downloader"))
+class CHUNKDOWNLOADERCUSTOM_API UCDL_PrepareLevel_AsyncAction : public UCDL_AsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+
+	// download and mount the chunks containing a level and its dependencies, then load it and its dependencies while the current level keeps running.
+	// the level stays in memory until the next map is loaded, so OpenLevel right after completion doesn't have to load anything.
+	// @param bPreScanAssets	If true, assets contained in the chunk files will be scanned with the Asset Registry after mounting.
+    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AdvancedDisplay = "bPreScanAssets"))
+	static UCDL_PrepareLevel_AsyncAction* PrepareLevel(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target
+		, TSoftObjectPtr<UWorld> Level, bool bPreScanAssets = false
+	);
+};
+
+UCLASS(meta=(DisplayName="Chunk Downloader"))
+class CHUNKDOWNLOADERCUSTOM_API UCDL_ScanAssetsInChunks_AsyncAction : public UCDL_AsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+
+	// scan the contents of mounted chunks with the Asset Registry, a few files per frame.
+    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target"))
+	static UCDL_ScanAssetsInChunks_AsyncAction* ScanAssetsInChunks(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target
+		, const TArray<int32>& ChunkIds
+	);
+};
+
 UCLASS(meta=(DisplayName="Chunk Downloader"))
 class CHUNKDOWNLOADERCUSTOM_API UCDL_DownloadChunks_AsyncAction : public UCDL_AsyncActionBase
 {
@@ -125,9 +185,9 @@ class CHUNKDOWNLOADERCUSTOM_API UCDL_DownloadChunks_AsyncAction : public UCDL_As
 public:
 
 	// Download (Cache) all pak files in these chunks then fire the callback (convenience wrapper managing multiple DownloadChunk calls)
-    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AdvancedDisplay = "Priority"))
+    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AdvancedDisplay = "Priority,DownloadClass"))
 	static UCDL_DownloadChunks_AsyncAction* DownloadChunks(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target
-		, const TArray<int32>& ChunkIds, int32 Priority = 0
+		, const TArray<int32>& ChunkIds, int32 Priority = 0, FName DownloadClass = NAME_None
 	);
 };
 
@@ -140,9 +200,9 @@ public:
 
 	// download all pak files in the chunk, but don't mount. Callback is fired when all paks have finished caching 
 	// (whether success or failure). Downloads will retry forever, but might fail due to space issues.
-    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AdvancedDisplay = "Priority"))
+    UFUNCTION(BlueprintCallable, Category = "Chunk Downloader|Latent", meta=(BlueprintInternalUseOnly="true", LatentInfo="LatentInfo", DefaultToSelf="Target", AdvancedDisplay = "Priority,DownloadClass"))
 	static UCDL_DownloadChunk_AsyncAction* DownloadChunk(FLatentActionInfo LatentInfo, UChunkDownloaderSubsystem* Target
-		, int32 ChunkId, int32 Priority = 0
+		, int32 ChunkId, int32 Priority = 0, FName DownloadClass = NAME_None
 	);
 };
 
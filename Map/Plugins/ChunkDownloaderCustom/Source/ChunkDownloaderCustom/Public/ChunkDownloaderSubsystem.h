@@ -4,6 +4,11 @@
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "ChunkDownloaderSubsystem.generated.h"
 
+class UPackage;
+class UWorld;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FChunkDeadlineDelegate, int32, ChunkId, FDateTime, Deadline, FDateTime, PredictedCompletion);
+
 UCLASS(Meta=(DisplayName="Chunk Downloader"))
 class CHUNKDOWNLOADERCUSTOM_API UChunkDownloaderSubsystem : public UGameInstanceSubsystem
 {
@@ -12,6 +17,9 @@ class CHUNKDOWNLOADERCUSTOM_API UChunkDownloaderSubsystem : public UGameInstance
 public:
 	DECLARE_DYNAMIC_DELEGATE_OneParam(FCallbackDelegate, bool, bSuccess);
 	typedef TFunction<void(bool bSuccess)> FCallback;
+	typedef TFunction<void(UPackage* Package)> FLoadPackageCallback;
+	DECLARE_DYNAMIC_DELEGATE_TwoParams(FChunkIdsDelegate, bool, bSuccess, const TArray<int32>&, ChunkIds);
+	typedef TFunction<void(bool bSuccess, const TArray<int32>& ChunkIds)> FChunkIdsCallback;
 
 	void Initialize(FSubsystemCollectionBase& Collection) override;
 	void Deinitialize() override;
@@ -62,6 +70,54 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
 	void GetAllChunkIds(TArray<int32>& OutChunkIds) const;
 
+	// get status and cached/total bytes for each of the specified chunks in one call
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
+	void GetChunkStatuses(const TArray<int32>& ChunkIds, TArray<FChunkStatusInfo>& OutStatuses) const;
+
+	// get status and cached/total bytes for every chunk in the current manifest
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
+	void GetAllChunkStatuses(TArray<FChunkStatusInfo>& OutStatuses) const;
+
+	// find which chunks contain a package (e.g. /Game/Maps/Level) before mounting them, from the build's content listing or from previous mounts.
+	// returns false if the package isn't in any known chunk.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
+	bool GetChunksForPackage(FName PackageName, TArray<int32>& OutChunkIds) const;
+
+	// find every chunk needed to load a package (e.g. a map): the ones containing it and its dependencies, recursively, using the asset registry data 
+	// shipped with the chunks. Pass the result to MountChunks to download the whole set in parallel. Fails if the package isn't in any known chunk.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
+	void ResolveChunkClosure(FName PackageName, FChunkIdsDelegate Callback);
+	void ResolveChunkClosure(FName PackageName, FChunkIdsCallback Callback);
+
+	// download (with top priority) and mount the chunks containing a package if they aren't mounted yet. Concurrent requests for the same package are merged.
+	// fails if the package isn't in any known chunk (see GetChunksForPackage) or if a chunk failed to mount.
+	// @param bPreScanAssets	If true, assets contained in the chunk files will be scanned with the Asset Registry after mounting.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay = "bPreScanAssets"))
+	void AcquirePackage(FName PackageName, bool bPreScanAssets, FCallbackDelegate Callback);
+	void AcquirePackage(FName PackageName, bool bPreScanAssets, FCallback Callback);
+
+	// read ahead the pak file data of some packages of a mounted chunk (all of them if PackageNames is empty) into the OS file cache, in the background,
+	// so that opening a level or loading assets right after mounting doesn't pay for cold reads. Fails if the chunk isn't mounted.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AutoCreateRefTerm = "PackageNames"))
+	void PrewarmChunk(int32 ChunkId, const TArray<FName>& PackageNames, FCallbackDelegate Callback);
+	void PrewarmChunk(int32 ChunkId, const TArray<FName>& PackageNames, FCallback Callback);
+
+	// get a level ready for travel while the current one keeps running: download and mount the chunks containing it and its dependencies
+	// (see ResolveChunkClosure), then load the map package and everything it depends on. The world and its dependencies are kept in memory until the next map finishes loading 
+	// (or ReleasePreparedLevels is called), so OpenLevel right after the callback doesn't have to load anything.
+	// @param bPreScanAssets	If true, assets contained in the chunk files will be scanned with the Asset Registry after mounting.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay = "bPreScanAssets"))
+	void PrepareLevel(TSoftObjectPtr<UWorld> Level, bool bPreScanAssets, FCallbackDelegate Callback);
+	void PrepareLevel(TSoftObjectPtr<UWorld> Level, bool bPreScanAssets, FCallback Callback);
+
+	// let go of levels loaded by PrepareLevel that we're not going to travel to after all
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
+	void ReleasePreparedLevels();
+
+	// load a package asynchronously. If that fails, acquire its chunks (see AcquirePackage) and try loading it once more.
+	// the callback gets the loaded package, or nullptr if it couldn't be loaded either way.
+	void LoadPackageAsync(FName PackageName, FLoadPackageCallback Callback);
+
 	// Unmount all chunks then fire the callback (convenience wrapper managing multiple UnmountChunk calls)
 	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
 	void UnmountChunks(const TArray<int32>& ChunkIds, FCallbackDelegate Callback);
@@ -74,9 +130,10 @@ public:
 
 	// Download and mount all chunks then fire the callback (convenience wrapper managing multiple MountChunk calls)
 	// @param bPreScanAssets	If true, assets contained in the chunk files will be scanned with the Asset Registry after mounting.
-	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta=(AdvancedDisplay="bPreScanAssets"))
-	void MountChunks(const TArray<int32>& ChunkIds, bool bPreScanAssets, FCallbackDelegate Callback);
-	void MountChunks(const TArray<int32>& ChunkIds, bool bPreScanAssets, FCallback Callback);
+	// @param bBatch			If true, chunks that are ready to mount are mounted together, with mount points registered and assets scanned once for all of them.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta=(AdvancedDisplay="bPreScanAssets,bBatch"))
+	void MountChunks(const TArray<int32>& ChunkIds, bool bPreScanAssets, FCallbackDelegate Callback, bool bBatch = false);
+	void MountChunks(const TArray<int32>& ChunkIds, bool bPreScanAssets, FCallback Callback, bool bBatch = false);
 
 	// download all pak files, then asynchronously mount them in order (in order among themselves, async with game thread).
 	// @param bPreScanAssets	If true, assets contained in the chunk files will be scanned with the Asset Registry after mounting.
@@ -84,16 +141,39 @@ public:
 	void MountChunk(int32 ChunkId, bool bPreScanAssets, FCallbackDelegate Callback);
 	void MountChunk(int32 ChunkId, bool bPreScanAssets, FCallback Callback);
 
+	// same as MountChunk, for a chunk that's needed within Deadline (from now). Among downloads of the same priority, the earliest deadline goes first.
+	// see OnDeadlineAtRisk to find out early when the deadline won't be met.
+	// @param bPreScanAssets	If true, assets contained in the chunk files will be scanned with the Asset Registry after mounting.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay = "bPreScanAssets"))
+	void MountChunkBefore(int32 ChunkId, FTimespan Deadline, bool bPreScanAssets, FCallbackDelegate Callback);
+	void MountChunkBefore(int32 ChunkId, FTimespan Deadline, bool bPreScanAssets, FCallback Callback);
+
 	// Download (Cache) all pak files in these chunks then fire the callback (convenience wrapper managing multiple DownloadChunk calls)
-	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay = "Priority"))
-	void DownloadChunks(const TArray<int32>& ChunkIds, FCallbackDelegate Callback, int32 Priority = 0);
-	void DownloadChunks(const TArray<int32>& ChunkIds, FCallback Callback, int32 Priority = 0);
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay = "Priority,DownloadClass"))
+	void DownloadChunks(const TArray<int32>& ChunkIds, FCallbackDelegate Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
+	void DownloadChunks(const TArray<int32>& ChunkIds, FCallback Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
 
 	// download all pak files in the chunk, but don't mount. Callback is fired when all paks have finished caching 
 	// (whether success or failure). Downloads will retry forever, but might fail due to space issues.
-	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay = "Priority"))
-	void DownloadChunk(int32 ChunkId, FCallbackDelegate Callback, int32 Priority = 0);
-	void DownloadChunk(int32 ChunkId, FCallback Callback, int32 Priority = 0);
+	// @param DownloadClass	Download classes share the download slots according to their weights (see DownloadClassWeights in config). A pak file already queued only changes class for a request at least as urgent (None being the default class).
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay = "Priority,DownloadClass"))
+	void DownloadChunk(int32 ChunkId, FCallbackDelegate Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
+	void DownloadChunk(int32 ChunkId, FCallback Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
+
+	// same as DownloadChunk, for a chunk that's needed within Deadline (from now). Among downloads of the same priority, the earliest deadline goes first.
+	// see OnDeadlineAtRisk to find out early when the deadline won't be met.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay = "Priority,DownloadClass"))
+	void DownloadChunkBefore(int32 ChunkId, FTimespan Deadline, FCallbackDelegate Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
+	void DownloadChunkBefore(int32 ChunkId, FTimespan Deadline, FCallback Callback, int32 Priority = 0, FName DownloadClass = NAME_None);
+
+	// called when a chunk requested with a deadline is predicted to miss it, from the downloads ahead of it and the measured bandwidth.
+	// fires once per deadline while there's still time to react, e.g. to keep the loading screen up.
+	UPROPERTY(BlueprintAssignable, Category = "Chunk Downloader")
+	FChunkDeadlineDelegate OnDeadlineAtRisk;
+
+	// smoothed download bandwidth measured while downloads are in progress, in bytes per second (0 until measured)
+	UFUNCTION(BlueprintPure, Category = "Chunk Downloader|Stats")
+	float GetDownloadBandwidth() const;
 
 	// flush any cached files (on disk) that are not currently being downloaded to or mounting (does not unmount the corresponding pak files).
 	// this will include full and partial downloads, but not active downloads.
@@ -106,6 +186,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
 	int32 ValidateCache();
 
+	// download every chunk that isn't cached yet in the background, one at a time at the lowest priority, whenever nothing else is queued.
+	// pauses in loading mode and while the disk quotas would be exceeded, and resumes in later sessions until stopped.
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
+	void StartBackgroundInstall();
+
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
+	void StopBackgroundInstall();
+
+	UFUNCTION(BlueprintPure, Category = "Chunk Downloader")
+	bool IsBackgroundInstalling() const;
+
+	// chunks and bytes cached out of the whole catalog, with an estimate of the time left at the current bandwidth
+	UFUNCTION(BlueprintPure, Category = "Chunk Downloader|Stats")
+	void GetBackgroundInstallProgress(FBackgroundInstallProgress& Progress) const;
+
 	// Snapshot stats and enter into loading screen mode (pauses all background downloads). Fires callback when all non-background 
 	// downloads have completed. If no downloads/mounts are currently queued by the end of the frame, callback will fire next frame.
 	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
@@ -125,6 +220,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
 	int32 ScanAssetsInChunk(int32 ChunkId);
 
+	// same as ScanAssetsInChunk for several chunks, but the files are scanned a few at a time over the next frames instead of blocking the game thread.
+	// the callback fires once everything was scanned (false if none of the chunks were mounted).
+	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader")
+	void ScanAssetsInChunksAsync(const TArray<int32>& ChunkIds, FCallbackDelegate Callback);
+	void ScanAssetsInChunksAsync(const TArray<int32>& ChunkIds, FCallback Callback);
+
+	// whether asynchronous asset scans are still in progress
+	UFUNCTION(BlueprintPure, Category = "Chunk Downloader")
+	bool IsScanningAssets() const;
+
 	// if mounted, inspect the files contained in the chunk and export it as an array of file paths.
 	// by default only cooked assets will be listed (.uasset and .umap files), but a flag can be set to export all contents, including .uexp files.
 	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta=(AdvancedDisplay="bCookedOnly"))
@@ -156,6 +261,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Chunk Downloader", meta = (AdvancedDisplay="2", AutoCreateRefTerm="Class", DeterminesOutputType="Class", DynamicOutputParam="Asset"))
 	void FindAssetInChunk(int32 ChunkId, TSoftObjectPtr<UObject>& Asset, bool bPreScanAssets, FName PackageName, FName PackagePath, bool bRecursivePath, TSubclassOf<UObject> Class, bool bRecursiveClass);
 
+private:
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	// worlds loaded by PrepareLevel and the assets they depend on, held until the next map is loaded
+	// (a package doesn't reference its objects, so holding the map package alone wouldn't keep anything loaded)
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UObject>> PreparedLevels;
+
+	FDelegateHandle PostLoadMapHandle;
+	FDelegateHandle DeadlineAtRiskHandle;
+
 };
 
 #if UE_ENABLE_INCLUDE_ORDER_DEPRECATED_IN_5_2
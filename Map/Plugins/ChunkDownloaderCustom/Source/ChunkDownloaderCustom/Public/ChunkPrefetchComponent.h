@@ -0,0 +1,108 @@
+
+#pragma once
+
+#include "Components/SceneComponent.h"
+#include "ChunkPrefetchComponent.generated.h"
+
+class UChunkDownloaderSubsystem;
+class UWorld;
+
+UENUM(BlueprintType)
+enum class EChunkPrefetchStage : uint8
+{
+	Idle, // player is outside every ring
+	Downloading, // player entered the download ring, chunks are downloading in the background
+	Prioritized, // player entered the priority ring, chunks are downloading ahead of background work
+	Mounting, // player entered the mount ring, chunks are being mounted (and the level prepared)
+	Ready, // chunks are mounted (and the level prepared)
+	Failed, // mounting (or preparing the level) failed
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FChunkPrefetchStageChanged, EChunkPrefetchStage, Stage);
+
+// Gets a set of chunks ready while the player approaches this component: starts a background download when the player pawn comes within
+// DownloadRadius, raises the download priority within PriorityRadius and mounts the chunks within MountRadius, so that a trigger
+// placed inside the mount ring (e.g. one waiting on WaitForPlayerOverlap to call OpenLevel) finds its content already there.
+// Stages only ever move forward, leaving a ring doesn't cancel anything.
+UCLASS(ClassGroup = "Chunk Downloader", meta = (BlueprintSpawnableComponent, DisplayName = "Chunk Prefetch"))
+class CHUNKDOWNLOADERCUSTOM_API UChunkPrefetchComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UChunkPrefetchComponent();
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// chunks to get ready
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch")
+	TArray<int32> ChunkIds;
+
+	// if set, the chunks this level needs (see ResolveChunkClosure) are added to ChunkIds, and the mount ring prepares the level (see bPrepareLevel)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch")
+	TSoftObjectPtr<UWorld> Level;
+
+	// if true and Level is set, the mount ring also loads the level into memory (see PrepareLevel) so OpenLevel doesn't have to
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch")
+	bool bPrepareLevel = true;
+
+	// if true, assets contained in the chunk files will be scanned with the Asset Registry after mounting
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch", AdvancedDisplay)
+	bool bPreScanAssets = false;
+
+	// distance from the player pawn at which the chunks start downloading in the background
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch", meta = (ClampMin = "0", Units = "cm"))
+	float DownloadRadius = 20000.0f;
+
+	// distance from the player pawn at which the download priority is raised to UrgentPriority
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch", meta = (ClampMin = "0", Units = "cm"))
+	float PriorityRadius = 10000.0f;
+
+	// distance from the player pawn at which the chunks are mounted
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch", meta = (ClampMin = "0", Units = "cm"))
+	float MountRadius = 4000.0f;
+
+	// download priority used in the download ring
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch", AdvancedDisplay)
+	int32 BackgroundPriority = -100;
+
+	// download priority used in the priority ring
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch", AdvancedDisplay)
+	int32 UrgentPriority = 100;
+
+	// download class the chunks are requested with (see DownloadClassWeights in config)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch", AdvancedDisplay)
+	FName DownloadClass;
+
+	// how often (in seconds) the distance to the player pawn is checked
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Prefetch", AdvancedDisplay, meta = (ClampMin = "0"))
+	float UpdateInterval = 0.25f;
+
+	// fired whenever the prefetch moves to another stage
+	UPROPERTY(BlueprintAssignable, Category = "Chunk Prefetch")
+	FChunkPrefetchStageChanged OnStageChanged;
+
+	UFUNCTION(BlueprintPure, Category = "Chunk Prefetch")
+	EChunkPrefetchStage GetStage() const { return Stage; }
+
+	// go through the rings from the start again (e.g. after the chunks were unmounted)
+	UFUNCTION(BlueprintCallable, Category = "Chunk Prefetch")
+	void ResetStage();
+
+private:
+	void SetStage(EChunkPrefetchStage NewStage);
+	void StartDownload(int32 Priority);
+	void StartMount();
+
+	UChunkDownloaderSubsystem* GetChunkDownloader() const;
+
+	EChunkPrefetchStage Stage = EChunkPrefetchStage::Idle;
+
+	// ChunkIds plus the chunks Level needs, once resolved
+	TArray<int32> PrefetchChunkIds;
+};
+
+#if UE_ENABLE_INCLUDE_ORDER_DEPRECATED_IN_5_2
+#include "CoreMinimal.h"
+#endif